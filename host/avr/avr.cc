@@ -0,0 +1,71 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-ins for the avr-libc runtime.
+
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+#include <string.h>
+
+HostStatusRegister SREG = { SREG_I };
+void (*host_interrupt_hook)();
+
+volatile uint8_t UCSR0A;
+volatile uint8_t UCSR0B;
+volatile uint8_t UDR0;
+volatile uint8_t TCNT0;
+volatile uint16_t TCNT1;
+volatile uint8_t TIFR0;
+
+// The heap is empty and there is no stack to watch.
+uint8_t __data_start, __data_end, __bss_start, __bss_end, __heap_start;
+uint8_t* __brkval;
+
+uint8_t host_eeprom[kHostEepromSize];
+uint32_t host_eeprom_writes[kHostEepromSize];
+
+static inline uint16_t eeprom_index(const void* address) {
+  return reinterpret_cast<uintptr_t>(address) % kHostEepromSize;
+}
+
+uint8_t eeprom_read_byte(const uint8_t* address) {
+  return host_eeprom[eeprom_index(address)];
+}
+
+void eeprom_write_byte(uint8_t* address, uint8_t value) {
+  uint16_t i = eeprom_index(address);
+  host_eeprom[i] = value;
+  ++host_eeprom_writes[i];
+}
+
+void eeprom_read_block(void* destination, const void* source, size_t size) {
+  uint8_t* d = static_cast<uint8_t*>(destination);
+  uint16_t i = eeprom_index(source);
+  while (size--) {
+    *d++ = host_eeprom[i++ % kHostEepromSize];
+  }
+}
+
+void eeprom_write_block(const void* source, void* destination, size_t size) {
+  const uint8_t* s = static_cast<const uint8_t*>(source);
+  uint16_t i = eeprom_index(destination);
+  while (size--) {
+    eeprom_write_byte(reinterpret_cast<uint8_t*>(i++ % kHostEepromSize), *s++);
+  }
+}
@@ -0,0 +1,39 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avr-libc's <avr/eeprom.h>. Writes complete immediately
+// and are counted per address.
+
+#ifndef HOST_AVR_EEPROM_H_
+#define HOST_AVR_EEPROM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+static const uint16_t kHostEepromSize = 1024;
+
+extern uint8_t host_eeprom[kHostEepromSize];
+extern uint32_t host_eeprom_writes[kHostEepromSize];
+
+uint8_t eeprom_read_byte(const uint8_t* address);
+void eeprom_write_byte(uint8_t* address, uint8_t value);
+void eeprom_read_block(void* destination, const void* source, size_t size);
+void eeprom_write_block(const void* source, void* destination, size_t size);
+
+static inline bool eeprom_is_ready() { return true; }
+
+#endif  // HOST_AVR_EEPROM_H_
@@ -0,0 +1,55 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avr-libc's <avr/interrupt.h>. The harness is single
+// threaded: interrupts are never triggered asynchronously. Instead, setting
+// the I bit of SREG calls host_interrupt_hook, from which the harness runs
+// the interrupts which have fallen due while they were disabled - as the
+// chip does when the code re-enables them.
+
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define SREG_I 0x80
+
+extern void (*host_interrupt_hook)();
+
+struct HostStatusRegister {
+  uint8_t value;
+
+  operator uint8_t() const { return value; }
+  HostStatusRegister& operator=(uint8_t v) {
+    value = v;
+    if ((v & SREG_I) && host_interrupt_hook) {
+      host_interrupt_hook();
+    }
+    return *this;
+  }
+};
+
+extern HostStatusRegister SREG;
+
+static inline void cli() { SREG.value &= ~SREG_I; }
+static inline void sei() { SREG = SREG.value | SREG_I; }
+
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR(vector, ...) extern "C" void vector(void)
+
+#endif  // HOST_AVR_INTERRUPT_H_
@@ -0,0 +1,56 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avr-libc's <avr/io.h>: the registers touched by the
+// firmware are plain variables, which the harness can inspect or preset.
+
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+
+#include <stdint.h>
+
+extern volatile uint8_t UCSR0A;
+extern volatile uint8_t UCSR0B;
+extern volatile uint8_t UDR0;
+extern volatile uint8_t TCNT0;
+extern volatile uint16_t TCNT1;
+extern volatile uint8_t TIFR0;
+
+#define RXCIE0 7
+#define FE0 4
+#define DOR0 3
+#define TOV0 0
+#define WGM12 3
+
+// Symbols from the linker and from malloc, used by StackMonitor. Some of
+// them are also defined by the host toolchain, hence the new names.
+#define __data_start host_data_start
+#define __data_end host_data_end
+#define __bss_start host_bss_start
+#define __bss_end host_bss_end
+#define __heap_start host_heap_start
+#define __brkval host_brkval
+
+extern uint8_t __heap_start;
+
+// There is no stack to scan on the host: the stack pointer is reported to
+// be right at the end of the heap.
+#define SP (reinterpret_cast<uintptr_t>(&__heap_start))
+
+#define RAMEND 0x8ff
+
+#endif  // HOST_AVR_IO_H_
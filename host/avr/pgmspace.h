@@ -0,0 +1,45 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avr-libc's <avr/pgmspace.h>: program memory is ordinary
+// memory.
+
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+
+// Reads through the pointer type, so that 16-bit words holding pointers on
+// the target hold full-width pointers here.
+#define pgm_read_byte(address) (*reinterpret_cast<const uint8_t*>(address))
+#define pgm_read_word(address) (*(address))
+
+#define memcpy_P memcpy
+#define memcmp_P memcmp
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strlen_P strlen
+
+typedef const char prog_char;
+typedef const uint8_t prog_uint8_t;
+typedef const uint16_t prog_uint16_t;
+
+#endif  // HOST_AVR_PGMSPACE_H_
@@ -0,0 +1,126 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-ins for the avrlib runtime, on top of the machine model.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "avrlib/serial.h"
+#include "avrlib/string.h"
+#include "avrlib/time.h"
+#include "avrlib/timer.h"
+#include "avrlib/watchdog_timer.h"
+
+#include "host/machine.h"
+
+using host::Machine;
+
+namespace avrlib {
+
+/* static */
+bool SerialPort0::readable() {
+  return Machine::input_readable();
+}
+
+/* static */
+uint8_t SerialPort0::Read() {
+  return Machine::ReadInput();
+}
+
+/* static */
+bool SerialPort0::writable() {
+  return Machine::output_writable();
+}
+
+/* static */
+void SerialPort0::Write(uint8_t byte) {
+  Machine::WriteOutput(byte);
+}
+
+uint32_t milliseconds() {
+  return Machine::now() / (host::kCpuFrequency / 1000);
+}
+
+void TickSystemClock() { }
+
+void Delay(uint16_t delay) {
+  Machine::AdvanceTo(
+      Machine::now() + static_cast<uint64_t>(delay) *
+          (host::kCpuFrequency / 1000));
+}
+
+/* static */
+void PwmChannel1A::set_frequency(uint16_t period) {
+  Machine::set_timer1_period(period);
+}
+
+void SystemReset(uint8_t timeout) {
+  fprintf(stderr, "System reset requested.\n");
+  exit(0);
+}
+
+void UnsafeItoa(int16_t value, uint8_t width, char* destination) {
+  char digits[8];
+  uint8_t size = 0;
+  bool negative = value < 0;
+  uint16_t magnitude = negative ? -value : value;
+  do {
+    digits[size++] = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude && size < sizeof(digits) - 1);
+  if (negative) {
+    digits[size++] = '-';
+  }
+  for (uint8_t i = 0; i < width; ++i) {
+    destination[i] = i < size ? digits[size - 1 - i] : ' ';
+  }
+}
+
+void AlignRight(char* source, uint8_t width) {
+  uint8_t end = 0;
+  while (end < width && source[end] && source[end] != ' ') {
+    ++end;
+  }
+  uint8_t shift = width - end;
+  for (int8_t i = end - 1; i >= 0; --i) {
+    source[i + shift] = source[i];
+  }
+  for (uint8_t i = 0; i < shift; ++i) {
+    source[i] = ' ';
+  }
+}
+
+void AlignLeft(char* source, uint8_t width) {
+  uint8_t start = 0;
+  while (start < width && source[start] == ' ') {
+    ++start;
+  }
+  for (uint8_t i = 0; i < width; ++i) {
+    uint8_t from = i + start;
+    source[i] = from < width && source[from] ? source[from] : ' ';
+  }
+}
+
+void PadRight(char* source, uint8_t width, char character) {
+  AlignRight(source, width);
+  for (uint8_t i = 0; i < width && source[i] == ' '; ++i) {
+    source[i] = character;
+  }
+}
+
+}  // namespace avrlib
@@ -0,0 +1,100 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/base.h.
+
+#ifndef HOST_AVRLIB_BASE_H_
+#define HOST_AVRLIB_BASE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+typedef uint8_t uint8;
+typedef int8_t int8;
+typedef uint16_t uint16;
+typedef int16_t int16;
+typedef uint32_t uint32;
+typedef int32_t int32;
+
+#define DISALLOW_COPY_AND_ASSIGN(TypeName) \
+  TypeName(const TypeName&); \
+  void operator=(const TypeName&)
+
+#define STATIC_ASSERT(expr) static_assert(expr, #expr)
+
+typedef union {
+  uint16_t value;
+  uint8_t bytes[2];
+} Word;
+
+typedef union {
+  uint32_t value;
+  uint16_t words[2];
+  uint8_t bytes[4];
+} LongWord;
+
+namespace avrlib {
+
+template<uint8_t size>
+struct DataTypeForSize {
+  typedef uint16_t Type;
+};
+
+template<>
+struct DataTypeForSize<8> {
+  typedef uint8_t Type;
+};
+
+}  // namespace avrlib
+
+template<typename T> constexpr uint8_t U8(T value) {
+  return static_cast<uint8_t>(value);
+}
+template<typename T> constexpr int8_t S8(T value) {
+  return static_cast<int8_t>(value);
+}
+template<typename T> constexpr uint16_t U16(T value) {
+  return static_cast<uint16_t>(value);
+}
+template<typename T> constexpr int16_t S16(T value) {
+  return static_cast<int16_t>(value);
+}
+
+constexpr uint8_t operator"" _u8(unsigned long long value) {
+  return static_cast<uint8_t>(value);
+}
+
+constexpr uint8_t byteAnd(uint8_t a, uint8_t b) { return a & b; }
+constexpr uint8_t byteOr(uint8_t a, uint8_t b) { return a | b; }
+constexpr uint8_t byteXor(uint8_t a, uint8_t b) { return a ^ b; }
+constexpr uint8_t bitFlag8(uint8_t bit) { return 1 << bit; }
+constexpr uint16_t bitFlag16(uint8_t bit) { return 1 << bit; }
+constexpr uint8_t bitFlag8Lookup(uint8_t bit) { return 1 << bit; }
+constexpr bool bitTest(uint8_t value, uint8_t bit) { return value & (1 << bit); }
+constexpr uint8_t lowByte(uint16_t value) { return value & 0xff; }
+constexpr uint8_t highByte(uint16_t value) { return value >> 8; }
+// Low 7 bits, and the 7 bits above them, of a MIDI data value.
+constexpr uint8_t U7(uint16_t value) { return value & 0x7f; }
+constexpr uint8_t MSB8(uint16_t value) { return (value >> 7) & 0x7f; }
+
+#include "avrlib/op.h"
+
+#endif  // HOST_AVRLIB_BASE_H_
@@ -0,0 +1,56 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/devices/buffered_display.h. The text printed by
+// the firmware is kept, so that the harness can read it back.
+
+#ifndef HOST_AVRLIB_DEVICES_BUFFERED_DISPLAY_H_
+#define HOST_AVRLIB_DEVICES_BUFFERED_DISPLAY_H_
+
+#include "avrlib/base.h"
+
+namespace avrlib {
+
+template<typename Lcd>
+class BufferedDisplay {
+ public:
+  enum {
+    width = Lcd::lcd_width,
+    height = Lcd::lcd_height
+  };
+  static inline void Init() {
+    memset(text_, ' ', sizeof(text_) - 1);
+  }
+  static inline void Print(uint8_t line, const char* text) {
+    char* destination = &text_[line * width];
+    for (uint8_t i = 0; i < width && text[i]; ++i) {
+      destination[i] = text[i];
+    }
+  }
+  static inline void Tick() { }
+  static inline void set_status(char status) { status_ = status; }
+  static inline char status() { return status_; }
+  static inline const char* text() { return text_; }
+
+ private:
+  static inline char text_[width * height + 1];
+  static inline char status_;
+};
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_DEVICES_BUFFERED_DISPLAY_H_
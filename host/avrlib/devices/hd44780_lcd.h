@@ -0,0 +1,43 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/devices/hd44780_lcd.h. Nothing is wired to it.
+
+#ifndef HOST_AVRLIB_DEVICES_HD44780_LCD_H_
+#define HOST_AVRLIB_DEVICES_HD44780_LCD_H_
+
+#include "avrlib/base.h"
+
+namespace avrlib {
+
+template<typename RsPin, typename EnablePin, typename ParallelPort,
+         uint8_t width = 16, uint8_t height = 2>
+class Hd44780Lcd {
+ public:
+  enum {
+    lcd_width = width,
+    lcd_height = height
+  };
+  static inline void Init() { }
+  static inline void Tick() { }
+  static inline void SetCustomCharMapRes(
+      const uint8_t* characters, uint8_t num_characters, uint8_t first_index) { }
+};
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_DEVICES_HD44780_LCD_H_
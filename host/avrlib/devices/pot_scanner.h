@@ -0,0 +1,39 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/devices/pot_scanner.h. All the pots rest at 0.
+
+#ifndef HOST_AVRLIB_DEVICES_POT_SCANNER_H_
+#define HOST_AVRLIB_DEVICES_POT_SCANNER_H_
+
+#include "avrlib/base.h"
+
+namespace avrlib {
+
+template<uint8_t num_inputs, uint8_t first_input_index = 0,
+         uint8_t oversampling = 8, uint8_t resolution = 10>
+class PotScanner {
+ public:
+  static inline void Init() { }
+  static inline void Read() { }
+  static inline uint8_t last_read() { return 0; }
+  static inline uint16_t value(uint8_t index) { return 0; }
+};
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_DEVICES_POT_SCANNER_H_
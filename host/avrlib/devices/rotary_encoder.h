@@ -0,0 +1,39 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/devices/rotary_encoder.h. Never turned, never
+// pressed: the harness posts UI events directly.
+
+#ifndef HOST_AVRLIB_DEVICES_ROTARY_ENCODER_H_
+#define HOST_AVRLIB_DEVICES_ROTARY_ENCODER_H_
+
+#include "avrlib/base.h"
+
+namespace avrlib {
+
+template<typename SwitchA, typename SwitchB, typename SwitchClick>
+class RotaryEncoder {
+ public:
+  static inline void Init() { }
+  static inline int8_t Read() { return 0; }
+  static inline uint8_t immediate_value() { return 0xff; }
+  static inline bool clicked() { return false; }
+};
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_DEVICES_ROTARY_ENCODER_H_
@@ -0,0 +1,53 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/gpio.h. Pins hold their level, nothing more.
+
+#ifndef HOST_AVRLIB_GPIO_H_
+#define HOST_AVRLIB_GPIO_H_
+
+#include "avrlib/base.h"
+
+namespace avrlib {
+
+enum PinMode {
+  DIGITAL_INPUT = 0,
+  DIGITAL_OUTPUT = 1
+};
+
+struct PortB { };
+struct PortC { };
+struct PortD { };
+
+template<typename Port, uint8_t bit>
+struct Gpio {
+  static inline void set_mode(uint8_t mode) { }
+  static inline void High() { level_ = 1; }
+  static inline void Low() { level_ = 0; }
+  static inline void Toggle() { level_ ^= 1; }
+  static inline void set_value(uint8_t value) { level_ = value ? 1 : 0; }
+  static inline uint8_t value() { return level_; }
+  static inline uint8_t is_high() { return level_; }
+  static inline uint8_t is_low() { return !level_; }
+
+ private:
+  static inline uint8_t level_;
+};
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_GPIO_H_
@@ -0,0 +1,65 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/op.h: the fixed-point helpers, in plain C++.
+
+#ifndef HOST_AVRLIB_OP_H_
+#define HOST_AVRLIB_OP_H_
+
+#include "avrlib/base.h"
+
+namespace avrlib {
+
+template<typename T, typename U>
+inline U Clip(T value, U min, U max) {
+  return value < min ? min : (value > max ? max : static_cast<U>(value));
+}
+
+inline uint8_t U8ShiftRight4(uint8_t a) { return a >> 4; }
+inline uint8_t U8ShiftLeft4(uint8_t a) { return a << 4; }
+inline uint8_t U8Swap4(uint8_t a) { return (a << 4) | (a >> 4); }
+inline uint8_t U16ShiftRight8(uint16_t a) { return a >> 8; }
+
+inline uint8_t U8U8MulShift8(uint8_t a, uint8_t b) {
+  return (static_cast<uint16_t>(a) * b) >> 8;
+}
+
+inline int8_t S8S8MulShift8(int8_t a, int8_t b) {
+  return (static_cast<int16_t>(a) * b) >> 8;
+}
+
+inline int16_t S16S8MulShift8(int16_t a, int8_t b) {
+  return (static_cast<int32_t>(a) * b) >> 8;
+}
+
+inline uint16_t U8U8Mul(uint8_t a, uint8_t b) {
+  return static_cast<uint16_t>(a) * b;
+}
+
+inline uint8_t U8Mix(uint8_t a, uint8_t b, uint8_t balance) {
+  return (a * static_cast<uint16_t>(255 - balance) + b * balance) >> 8;
+}
+
+inline uint8_t InterpolateSample(const uint8_t* table, uint16_t phase) {
+  uint8_t index = phase >> 8;
+  uint8_t fractional = phase & 0xff;
+  return U8Mix(table[index], table[index + 1], fractional);
+}
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_OP_H_
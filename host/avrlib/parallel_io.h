@@ -0,0 +1,42 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/parallel_io.h.
+
+#ifndef HOST_AVRLIB_PARALLEL_IO_H_
+#define HOST_AVRLIB_PARALLEL_IO_H_
+
+#include "avrlib/base.h"
+
+namespace avrlib {
+
+enum ParallelPortMode {
+  PARALLEL_BYTE,
+  PARALLEL_NIBBLE_HIGH,
+  PARALLEL_NIBBLE_LOW,
+};
+
+template<typename Port, ParallelPortMode parallel_mode = PARALLEL_BYTE>
+struct ParallelPort {
+  static inline void set_mode(uint8_t mode) { }
+  static inline void Write(uint8_t value) { }
+  static inline uint8_t Read() { return 0; }
+};
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_PARALLEL_IO_H_
@@ -0,0 +1,53 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/random.h. Same linear congruential generator as
+// on the target, so that runs are reproducible.
+
+#ifndef HOST_AVRLIB_RANDOM_H_
+#define HOST_AVRLIB_RANDOM_H_
+
+#include "avrlib/base.h"
+
+namespace avrlib {
+
+class Random {
+ public:
+  static inline void Update() {
+    rng_state_ = rng_state_ * 1664525L + 1013904223L;
+  }
+  static inline uint16_t state() { return rng_state_ >> 16; }
+  static inline void Seed(uint16_t seed) { rng_state_ = seed; }
+  static inline uint8_t state_msb() { return rng_state_ >> 24; }
+  static inline uint8_t GetByte() {
+    Update();
+    return state_msb();
+  }
+  static inline uint16_t GetWord() {
+    Update();
+    return state();
+  }
+
+ private:
+  static inline uint32_t rng_state_ = 0x21;
+
+  DISALLOW_COPY_AND_ASSIGN(Random);
+};
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_RANDOM_H_
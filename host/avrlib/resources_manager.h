@@ -0,0 +1,59 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/resources_manager.h.
+
+#ifndef HOST_AVRLIB_RESOURCES_MANAGER_H_
+#define HOST_AVRLIB_RESOURCES_MANAGER_H_
+
+#include "avrlib/base.h"
+
+namespace avrlib {
+
+template<const char* const* strings, const uint16_t* const* lookup_tables>
+struct ResourcesTables {
+  static inline const char* const* string_table() { return strings; }
+  static inline const uint16_t* const* lookup_table_table() {
+    return lookup_tables;
+  }
+};
+
+template<typename ResourceId = uint8_t, typename Tables = void>
+struct ResourcesManager {
+  static inline void LoadStringResource(
+      ResourceId resource, char* buffer, uint8_t buffer_size) {
+    const char* address = Tables::string_table()[resource];
+    if (!address) {
+      return;
+    }
+    strncpy(buffer, address, buffer_size);
+  }
+
+  template<typename ResultType, typename IndexType, typename T>
+  static inline ResultType Lookup(const T* p, IndexType i) {
+    return static_cast<ResultType>(p[i]);
+  }
+
+  template<typename ResultType, typename IndexType>
+  static inline ResultType Lookup(ResourceId resource, IndexType i) {
+    return static_cast<ResultType>(Tables::lookup_table_table()[resource][i]);
+  }
+};
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_RESOURCES_MANAGER_H_
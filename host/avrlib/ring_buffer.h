@@ -0,0 +1,86 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/ring_buffer.h.
+
+#ifndef HOST_AVRLIB_RING_BUFFER_H_
+#define HOST_AVRLIB_RING_BUFFER_H_
+
+#include "avrlib/base.h"
+
+namespace avrlib {
+
+// Single producer, single consumer ring buffer. One slot is kept empty to
+// tell a full buffer from an empty one.
+template<typename Specs>
+class RingBuffer {
+ public:
+  typedef typename DataTypeForSize<Specs::data_size>::Type Value;
+  enum {
+    size = Specs::buffer_size,
+    mask = size - 1
+  };
+
+  static inline uint8_t capacity() { return size - 1; }
+  static inline uint8_t writable() {
+    return (read_ptr_ - write_ptr_ - 1) & mask;
+  }
+  static inline uint8_t readable() {
+    return (write_ptr_ - read_ptr_) & mask;
+  }
+  static inline void Write(Value v) {
+    while (!writable());
+    Overwrite(v);
+  }
+  static inline void Overwrite(Value v) {
+    buffer_[write_ptr_] = v;
+    write_ptr_ = (write_ptr_ + 1) & mask;
+    ++num_written_;
+  }
+  static inline Value Read() {
+    while (!readable());
+    return ImmediateRead();
+  }
+  static inline Value ImmediateRead() {
+    Value result = buffer_[read_ptr_];
+    read_ptr_ = (read_ptr_ + 1) & mask;
+    ++num_read_;
+    return result;
+  }
+  static inline void Flush() {
+    num_read_ += readable();
+    read_ptr_ = write_ptr_;
+  }
+
+  // Only on the host: number of values which have gone through the buffer,
+  // used by the harness to follow them.
+  static inline uint32_t num_written() { return num_written_; }
+  static inline uint32_t num_read() { return num_read_; }
+
+ private:
+  static inline Value buffer_[size];
+  static inline volatile uint8_t read_ptr_;
+  static inline volatile uint8_t write_ptr_;
+  static inline uint32_t num_written_;
+  static inline uint32_t num_read_;
+
+  DISALLOW_COPY_AND_ASSIGN(RingBuffer);
+};
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_RING_BUFFER_H_
@@ -0,0 +1,61 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/serial.h. The only port is the MIDI UART, which
+// exchanges bytes with the host machine model (see host/machine.h).
+
+#ifndef HOST_AVRLIB_SERIAL_H_
+#define HOST_AVRLIB_SERIAL_H_
+
+#include "avrlib/base.h"
+#include "avrlib/ring_buffer.h"
+
+namespace avrlib {
+
+enum PortMode {
+  DISABLED = 0,
+  POLLED = 1,
+  BUFFERED = 2
+};
+
+struct SerialPort0 {
+  static bool readable();
+  static uint8_t Read();
+  static bool writable();
+  static void Write(uint8_t byte);
+};
+
+template<typename Port, uint32_t baud_rate, PortMode input, PortMode output>
+struct Serial {
+  static inline void Init() { }
+  static inline bool readable() { return Port::readable(); }
+  static inline bool writable() { return Port::writable(); }
+  static inline uint8_t ImmediateRead() { return Port::Read(); }
+  static inline uint8_t Read() {
+    while (!readable());
+    return ImmediateRead();
+  }
+  static inline void Overwrite(uint8_t byte) { Port::Write(byte); }
+  static inline void Write(uint8_t byte) {
+    while (!writable());
+    Overwrite(byte);
+  }
+};
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_SERIAL_H_
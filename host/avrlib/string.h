@@ -0,0 +1,46 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/string.h: formatting helpers for the LCD line
+// buffer. None of them write a terminating null.
+
+#ifndef HOST_AVRLIB_STRING_H_
+#define HOST_AVRLIB_STRING_H_
+
+#include "avrlib/base.h"
+
+namespace avrlib {
+
+// Writes value in at most width characters, left aligned and padded with
+// spaces.
+void UnsafeItoa(int16_t value, uint8_t width, char* destination);
+
+// Moves the text in the first width characters to the right (or left),
+// turning the null terminator and anything after it into spaces.
+void AlignRight(char* source, uint8_t width);
+void AlignLeft(char* source, uint8_t width);
+
+// Replaces the leading spaces of a right aligned field with character.
+void PadRight(char* source, uint8_t width, char character);
+
+inline char NibbleToAscii(uint8_t digit) {
+  return digit < 10 ? digit + 48 : digit + 87;
+}
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_STRING_H_
@@ -0,0 +1,55 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/timer.h. The harness runs the interrupt handlers
+// itself; the timers only record the TIMER1 period set by the firmware.
+
+#ifndef HOST_AVRLIB_TIMER_H_
+#define HOST_AVRLIB_TIMER_H_
+
+#include "avrlib/base.h"
+
+namespace avrlib {
+
+enum TimerMode {
+  TIMER_NORMAL = 0,
+  TIMER_PWM_PHASE_CORRECT = 1,
+  TIMER_CTC = 2,
+  TIMER_FAST_PWM = 3,
+};
+
+template<int n>
+struct Timer {
+  static inline void set_prescaler(uint8_t prescaler) { }
+  static inline void set_mode(uint8_t mode) { }
+  static inline void set_mode(uint8_t wg_bits_a, uint8_t wg_bits_b,
+                              uint8_t prescaler) { }
+  static inline void Start() { }
+  static inline void Stop() { }
+  static inline void StartCompare() { }
+  static inline void StopCompare() { }
+};
+
+// Output compare of timer 1: its value is the number of CPU cycles between
+// two internal clock interrupts.
+struct PwmChannel1A {
+  static void set_frequency(uint16_t period);
+};
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_TIMER_H_
@@ -0,0 +1,80 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host stand-in for avrlib/ui/event_queue.h.
+
+#ifndef HOST_AVRLIB_UI_EVENT_QUEUE_H_
+#define HOST_AVRLIB_UI_EVENT_QUEUE_H_
+
+#include "avrlib/base.h"
+#include "avrlib/time.h"
+
+namespace avrlib {
+
+enum ControlType {
+  CONTROL_POT = 1,
+  CONTROL_ENCODER = 2,
+  CONTROL_ENCODER_CLICK = 3,
+  CONTROL_SWITCH = 4,
+  CONTROL_SWITCH_HOLD = 5,
+  CONTROL_REFRESH = 0xff
+};
+
+struct Event {
+  uint8_t control_type;
+  uint8_t control_id;
+  uint8_t value;
+};
+
+template<uint8_t size = 8>
+class EventQueue {
+ public:
+  static inline void Flush() { read_ptr_ = write_ptr_ = 0; }
+  static inline void AddEvent(uint8_t control_type, uint8_t id,
+                              uint8_t value) {
+    uint8_t next = (write_ptr_ + 1) % size;
+    if (next == read_ptr_) {
+      return;
+    }
+    events_[write_ptr_].control_type = control_type;
+    events_[write_ptr_].control_id = id;
+    events_[write_ptr_].value = value;
+    write_ptr_ = next;
+  }
+  static inline uint8_t available() {
+    return (write_ptr_ + size - read_ptr_) % size;
+  }
+  static inline Event PullEvent() {
+    Event e = events_[read_ptr_];
+    read_ptr_ = (read_ptr_ + 1) % size;
+    return e;
+  }
+  static inline void Touch() { last_event_time_ = milliseconds(); }
+  static inline uint32_t idle_time_ms() {
+    return milliseconds() - last_event_time_;
+  }
+
+ private:
+  static inline Event events_[size];
+  static inline uint8_t read_ptr_;
+  static inline uint8_t write_ptr_;
+  static inline uint32_t last_event_time_;
+};
+
+}  // namespace avrlib
+
+#endif  // HOST_AVRLIB_UI_EVENT_QUEUE_H_
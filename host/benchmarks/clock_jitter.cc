@@ -0,0 +1,141 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+//
+// Jitter of the MIDI clock sent by the apps running on the internal clock,
+// alone and with a dense stream of notes going through them. The interval
+// between two 0xf8 bytes is measured at the time they are written to the
+// UART. The apps are started with a 0xfa, which the clock source waits for.
+// The arpeggiator only runs while a note is held, so one is held through
+// both measurements.
+//
+// A clock byte finding the UART busy waits for the byte being sent, then
+// for the next TIMER2 interrupt to send it - unless the code waiting on the
+// UART sends it first. Apps which do not handle the clock in the TIMER1
+// interrupt see their ticks up to one more TIMER2 period late. The maximum
+// deviation of the intervals is checked against these bounds.
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "host/harness.h"
+#include "midipal/app.h"
+#include "midipal/apps/arpeggiator.h"
+#include "midipal/apps/clock_source.h"
+#include "midipal/apps/clock_source_hd.h"
+#include "midipal/apps/delay.h"
+#include "midipal/apps/lfo.h"
+#include "midipal/resources.h"
+
+using namespace midipal;
+using host::Harness;
+
+static const uint32_t kDuration = 10000;  // In ms.
+
+static const double kRealtimeBound =
+    (host::kUartByteTime + host::kTimer2Period) * 1e6 / host::kCpuFrequency;
+static const double kDeferredBound =
+    kRealtimeBound + host::kTimer2Period * 1e6 / host::kCpuFrequency;
+
+static const AppInfo* const apps_with_clock[] = {
+  &apps::Arpeggiator::app_info_,
+  &apps::Delay::app_info_,
+  &apps::Lfo::app_info_,
+#ifdef USE_HD_CLOCK
+  &apps::ClockSourceHD::app_info_,
+#else
+  &apps::ClockSource::app_info_,
+#endif  // USE_HD_CLOCK
+};
+
+// Returns false if the clock output is missing or exceeds its bound.
+static bool Measure(uint8_t app, const std::vector<host::TimedMessage>* stream) {
+  Harness::Init(app);
+  if (app == Harness::app_index(&apps::Lfo::app_info_)) {
+    App::SetParameter(apps::Lfo::running_, 1);
+  }
+  const uint8_t start = 0xfa;
+  Harness::Feed(&start, 1);
+  if (app == Harness::app_index(&apps::Arpeggiator::app_info_)) {
+    Harness::Feed(0x90, 60, 100);
+  }
+  if (stream) {
+    Harness::Feed(*stream);
+  }
+  Harness::Run(host::kCpuFrequency / 1000 * kDuration);
+  std::vector<host::TimedByte> output = Harness::Collect();
+
+  std::vector<double> intervals;
+  uint64_t previous = 0;
+  for (const auto& b : output) {
+    if (b.byte != 0xf8) {
+      continue;
+    }
+    if (previous) {
+      intervals.push_back((b.time - previous) * 1e6 / host::kCpuFrequency);
+    }
+    previous = b.time;
+  }
+  char name[9];
+  memset(name, 0, sizeof(name));
+  ResourcesManager::LoadStringResource(App::app_name(), name, 8);
+  if (intervals.empty()) {
+    printf("%-9s %-6s no clock output\n", name, stream ? "notes" : "idle");
+    return false;
+  }
+  double mean = 0.0;
+  for (double i : intervals) {
+    mean += i;
+  }
+  mean /= intervals.size();
+  double variance = 0.0;
+  double max_deviation = 0.0;
+  for (double i : intervals) {
+    variance += (i - mean) * (i - mean);
+    max_deviation = fmax(max_deviation, fabs(i - mean));
+  }
+  variance /= intervals.size();
+  double bound = App::realtime_clock_handling() ? kRealtimeBound
+                                                : kDeferredBound;
+  bool ok = max_deviation <= bound;
+  printf("%-9s %-6s %7zu %10.1f %10.1f %10.1f %10.1f %s\n",
+         name, stream ? "notes" : "idle",
+         intervals.size() + 1, mean, sqrt(variance), max_deviation,
+         bound, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  std::vector<host::TimedMessage> stream;
+  host::GenerateDenseStream(kDuration, &stream);
+  printf("%-9s %-6s %7s %10s %10s %10s %10s\n",
+         "app", "input", "ticks", "interval", "stddev", "max dev", "bound");
+  bool ok = true;
+  for (const AppInfo* info : apps_with_clock) {
+    uint8_t app = Harness::app_index(info);
+    if (app == 0xff) {
+      continue;
+    }
+    ok &= Measure(app, NULL);
+    ok &= Measure(app, &stream);
+  }
+  printf("(times in us)\n");
+  return ok ? 0 : 1;
+}
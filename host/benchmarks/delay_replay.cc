@@ -0,0 +1,110 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+//
+// Replays a dense MIDI stream through the Delay app, with enough taps to keep
+// the event scheduler full, and reports the host time spent per timer 2
+// period: the clock ticks walking and advancing the scheduler, and the note
+// messages scheduling their echoes, happen there. Built once per scheduler
+// backend (delay_replay and delay_replay_wheel), to compare them.
+//
+// Usage: delay_replay [file.mid]. Without a file, replays 60s of
+// host::GenerateDenseStream().
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "host/benchmarks/cycles.h"
+#include "host/harness.h"
+#include "midipal/app.h"
+#include "midipal/apps/delay.h"
+#include "midipal/event_scheduler.h"
+
+using namespace midipal;
+using host::Cycles;
+using host::Harness;
+
+// Taps, and delay as an index in the clock division table.
+static const uint8_t presets[][2] = {
+  { 4, 8 },
+  { 16, 8 },
+  { 32, 4 },
+  { 32, 12 },
+};
+
+int main(int argc, char** argv) {
+  std::vector<host::TimedMessage> stream;
+  if (argc > 1) {
+    if (!host::ReadStandardMidiFile(argv[1], &stream)) {
+      fprintf(stderr, "Cannot read %s\n", argv[1]);
+      return 1;
+    }
+  } else {
+    host::GenerateDenseStream(60000, &stream);
+  }
+  uint8_t delay = Harness::app_index(&apps::Delay::app_info_);
+  if (delay == 0xff) {
+    fprintf(stderr, "The Delay app is not built in\n");
+    return 1;
+  }
+#ifdef USE_TIMING_WHEEL_SCHEDULER
+  printf("timing wheel scheduler, %zu messages\n", stream.size());
+#else
+  printf("delta list scheduler, %zu messages\n", stream.size());
+#endif  // USE_TIMING_WHEEL_SCHEDULER
+  printf("%5s %5s %10s %10s %10s %6s %6s\n",
+         "taps", "delay", "mean", "p99", "max", "peak", "full");
+  for (const auto& preset : presets) {
+    Harness::Init(delay);
+    App::SetParameter(apps::Delay::num_taps_, preset[0]);
+    App::SetParameter(apps::Delay::delay_, preset[1]);
+    Harness::Feed(stream);
+
+    std::vector<uint64_t> costs;
+    uint8_t peak = 0;
+    uint32_t full = 0;
+    uint64_t end = host::Machine::input_end();
+    while (host::Machine::now() < end) {
+      uint64_t start = Cycles();
+      Harness::Run(host::kTimer2Period);
+      costs.push_back(Cycles() - start);
+      uint8_t size = EventScheduler::size();
+      peak = std::max(peak, size);
+      if (EventScheduler::overflow()) {
+        ++full;
+      }
+      Harness::Collect();
+    }
+    std::sort(costs.begin(), costs.end());
+    uint64_t total = 0;
+    for (uint64_t cost : costs) {
+      total += cost;
+    }
+    printf("%5d %5d %10.1f %10llu %10llu %6d %6u\n",
+           preset[0], preset[1],
+           static_cast<double>(total) / costs.size(),
+           static_cast<unsigned long long>(costs[costs.size() * 99 / 100]),
+           static_cast<unsigned long long>(costs.back()),
+           peak, full);
+  }
+  printf("(host cycles per timer 2 period; peak scheduler entries; "
+         "periods with the scheduler\n"
+         "within 8 entries of full)\n");
+  return 0;
+}
@@ -0,0 +1,153 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host time spent by each app on the typical input messages, parsing
+// included. Times are those of the host CPU: they tell which apps and which
+// messages are expensive relative to one another, not how long they take on
+// the ATmega. Built once per dispatch mode (message_cost and
+// message_cost_static), to compare them.
+
+#include <stdio.h>
+
+#include <chrono>
+
+#include "host/harness.h"
+#include "midipal/app.h"
+#include "midipal/clock.h"
+#include "midipal/engine.h"
+#include "midipal/midi_handler.h"
+#include "midipal/resources.h"
+
+using namespace midipal;
+using host::Harness;
+
+static const uint16_t kNumIterations = 2000;
+static const uint8_t kNumRuns = 5;
+
+// Empties the output as fast as the app fills it. With the UART always
+// ready, the measure does not include waiting for it either.
+static void DiscardOutput() {
+  uint8_t byte;
+  while (Engine::PopOutputByte(&byte));
+  while (RealtimeOutput::Buffer::readable()) {
+    RealtimeOutput::Buffer::ImmediateRead();
+  }
+}
+
+enum Workload {
+  WORKLOAD_NOTES,
+  WORKLOAD_CONTROL_CHANGE,
+  WORKLOAD_CLOCK,
+  WORKLOAD_INTERNAL_CLOCK,
+  WORKLOAD_LAST
+};
+
+static const char* const workload_names[WORKLOAD_LAST] = {
+  "note on/off",
+  "cc",
+  "ext clock",
+  "int clock",
+};
+
+static void PushMessage(uint8_t a, uint8_t b, uint8_t c, uint8_t size) {
+  Engine::PushInputByte(a);
+  if (size > 1) {
+    Engine::PushInputByte(b);
+  }
+  if (size > 2) {
+    Engine::PushInputByte(c);
+  }
+}
+
+// Returns the average time per message, in nanoseconds.
+static double Measure(Workload workload) {
+  if (workload == WORKLOAD_CLOCK) {
+    PushMessage(0xfa, 0, 0, 1);
+  } else if (workload == WORKLOAD_INTERNAL_CLOCK) {
+    Clock::Start();
+  }
+  DiscardOutput();
+  auto start = std::chrono::steady_clock::now();
+  for (uint16_t i = 0; i < kNumIterations; ++i) {
+    uint8_t note = 36 + (i * 7) % 48;
+    switch (workload) {
+      case WORKLOAD_NOTES:
+        PushMessage(0x90, note, 100, 3);
+        PushMessage(0x80, note, 0, 3);
+        break;
+      case WORKLOAD_CONTROL_CHANGE:
+        PushMessage(0xb0, 1, i & 0x7f, 3);
+        break;
+      case WORKLOAD_CLOCK:
+        PushMessage(0xf8, 0, 0, 1);
+        break;
+      case WORKLOAD_INTERNAL_CLOCK:
+        Engine::OnInternalClockTick();
+        Engine::ProcessClockTicks();
+        break;
+      default:
+        break;
+    }
+    DiscardOutput();
+  }
+  auto end = std::chrono::steady_clock::now();
+  if (workload == WORKLOAD_CLOCK) {
+    PushMessage(0xfc, 0, 0, 1);
+  } else if (workload == WORKLOAD_INTERNAL_CLOCK) {
+    Clock::Stop();
+  }
+  DiscardOutput();
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  uint16_t num_messages = workload == WORKLOAD_NOTES ? 2 : 1;
+  return ns / (kNumIterations * num_messages);
+}
+
+int main(int argc, char** argv) {
+#ifdef STATIC_APP_DISPATCH
+  printf("static app dispatch\n");
+#else
+  printf("app dispatch through AppInfo\n");
+#endif  // STATIC_APP_DISPATCH
+  printf("%-10s", "app");
+  for (uint8_t w = 0; w < WORKLOAD_LAST; ++w) {
+    printf(" %12s", workload_names[w]);
+  }
+  printf("   (ns per message)\n");
+  for (uint8_t app = 0; app < App::num_apps(); ++app) {
+    Harness::Init(app);
+    host::Machine::set_instant_output(true);
+    char name[9] = "selector";
+    if (app) {
+      memset(name, 0, sizeof(name));
+      ResourcesManager::LoadStringResource(App::app_name(), name, 8);
+    }
+    printf("%-10s", name);
+    for (uint8_t w = 0; w < WORKLOAD_LAST; ++w) {
+      // Best of a few runs, to leave out the noise of the host.
+      double best = Measure(static_cast<Workload>(w));
+      for (uint8_t run = 1; run < kNumRuns; ++run) {
+        double t = Measure(static_cast<Workload>(w));
+        if (t < best) {
+          best = t;
+        }
+      }
+      printf(" %12.1f", best);
+    }
+    printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,145 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+//
+// Host time spent by each stage of the Filter -> ScaleProcessor -> Arpeggiator
+// pipeline. Messages are fed to the first stage, as input bytes, and to each
+// of the other stages as if the previous one had sent them: the cost of a
+// stage is the difference between the cost of the chain from this stage on,
+// and from the next one on. The cost of the first stage includes parsing.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "host/harness.h"
+#include "midipal/app.h"
+#include "midipal/app_registry.h"
+#include "midipal/clock.h"
+#include "midipal/engine.h"
+#include "midipal/midi_handler.h"
+#include "midipal/pipeline.h"
+#include "midipal/resources.h"
+
+using namespace midipal;
+using host::Harness;
+
+static const uint16_t kNumIterations = 4000;
+
+static void DiscardOutput() {
+  uint8_t byte;
+  while (Engine::PopOutputByte(&byte));
+  while (RealtimeOutput::Buffer::readable()) {
+    RealtimeOutput::Buffer::ImmediateRead();
+  }
+}
+
+// Feeds a message to stage, and to the stages after it.
+static void Feed(uint8_t stage, const uint8_t* bytes, uint8_t size) {
+  if (stage == 0) {
+    for (uint8_t i = 0; i < size; ++i) {
+      Engine::PushInputByte(bytes[i]);
+    }
+  } else {
+    uint8_t data[2] = { bytes[1], bytes[2] };
+    uint8_t previous = Pipeline::Select(stage - 1);
+    Pipeline::Forward(bytes[0], data, size - 1);
+    Pipeline::Select(previous);
+  }
+}
+
+enum Workload {
+  WORKLOAD_NOTES,
+  WORKLOAD_CONTROL_CHANGE,
+  WORKLOAD_LAST
+};
+
+// Returns the average time per message entering at stage, in nanoseconds.
+static double Measure(uint8_t stage, Workload workload) {
+  Harness::Init(1);
+  host::Machine::set_instant_output(true);
+  DiscardOutput();
+  auto start = std::chrono::steady_clock::now();
+  for (uint16_t i = 0; i < kNumIterations; ++i) {
+    uint8_t note = 36 + (i * 7) % 48;
+    if (workload == WORKLOAD_NOTES) {
+      uint8_t on[3] = { 0x90, note, 100 };
+      uint8_t off[3] = { 0x80, note, 0 };
+      Feed(stage, on, 3);
+      Feed(stage, off, 3);
+    } else {
+      uint8_t cc[3] = { 0xb0, 1, static_cast<uint8_t>(i & 0x7f) };
+      Feed(stage, cc, 3);
+    }
+    DiscardOutput();
+  }
+  auto end = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  return ns / (kNumIterations * (workload == WORKLOAD_NOTES ? 2 : 1));
+}
+
+int main(int argc, char** argv) {
+  printf("%-10s %12s %12s   (ns per message)\n", "stage", "note on/off",
+         "cc");
+  double from[kNumPipelineStages + 1][WORKLOAD_LAST];
+  for (uint8_t w = 0; w < WORKLOAD_LAST; ++w) {
+    from[kNumPipelineStages][w] = 0.0;
+    for (uint8_t s = 0; s < kNumPipelineStages; ++s) {
+      from[s][w] = Measure(s, static_cast<Workload>(w));
+    }
+  }
+  for (uint8_t s = 0; s < kNumPipelineStages; ++s) {
+    // The stages follow the app selector in the registry.
+    char name[9];
+    memset(name, 0, sizeof(name));
+    ResourcesManager::LoadStringResource(
+        AppRegistry::info[s + 1]->app_name, name, 8);
+    printf("%-10s", name);
+    for (uint8_t w = 0; w < WORKLOAD_LAST; ++w) {
+      printf(" %12.1f", from[s][w] - from[s + 1][w]);
+    }
+    printf("\n");
+  }
+  printf("%-10s", "chain");
+  for (uint8_t w = 0; w < WORKLOAD_LAST; ++w) {
+    printf(" %12.1f", from[0][w]);
+  }
+  printf("\n");
+
+  // The arpeggiator plays a held chord on each tick.
+  Harness::Init(1);
+  host::Machine::set_instant_output(true);
+  static const uint8_t chord[] = { 60, 64, 67 };
+  for (uint8_t note : chord) {
+    uint8_t on[3] = { 0x90, note, 100 };
+    Feed(0, on, 3);
+  }
+  Clock::Start();
+  auto start = std::chrono::steady_clock::now();
+  for (uint16_t i = 0; i < kNumIterations; ++i) {
+    Pipeline::OnInternalClock(true);
+    Pipeline::OnInternalClock(false);
+    DiscardOutput();
+  }
+  auto end = std::chrono::steady_clock::now();
+  printf("%-10s %12.1f   (ns per internal clock tick, all stages)\n",
+         "clock",
+         std::chrono::duration<double, std::nano>(end - start).count() /
+             kNumIterations);
+  return 0;
+}
@@ -0,0 +1,142 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+//
+// Replays a MIDI stream through each app, at the timing of the MIDI wire, and
+// reports for each app and preset how it keeps up: latency percentiles of the
+// messages it passes through or answers immediately, high-water mark of the
+// output buffer, flushes which had to wait for the UART (stalls), messages
+// dropped, and input bytes lost.
+//
+// Usage: replay [file.mid]. Without a file, replays 20s of
+// host::GenerateDenseStream().
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "host/harness.h"
+#include "midipal/app.h"
+#include "midipal/apps/arpeggiator.h"
+#include "midipal/apps/chord_memory.h"
+#include "midipal/apps/delay.h"
+#include "midipal/apps/dispatcher.h"
+#include "midipal/midi_handler.h"
+#include "midipal/resources.h"
+
+using namespace midipal;
+using host::Harness;
+
+struct Preset {
+  const AppInfo* app;
+  const char* name;
+  uint8_t num_settings;
+  uint8_t settings[3][2];  // Key, value.
+};
+
+// Variants of the factory settings for the apps played live.
+static const Preset presets[] = {
+  { &apps::Arpeggiator::app_info_, "4 oct", 1,
+    { { apps::Arpeggiator::num_octaves_, 4 } } },
+  { &apps::Arpeggiator::app_info_, "fast", 2,
+    { { apps::Arpeggiator::clock_division_, 16 },
+      { apps::Arpeggiator::bpm_, 240 } } },
+  { &apps::Delay::app_info_, "16 taps", 1,
+    { { apps::Delay::num_taps_, 16 } } },
+  { &apps::Delay::app_info_, "32 taps", 2,
+    { { apps::Delay::num_taps_, 32 }, { apps::Delay::delay_, 4 } } },
+  { &apps::ChordMemory::app_info_, "6 notes", 1,
+    { { apps::ChordMemory::num_notes_, 6 } } },
+  { &apps::Dispatcher::app_info_, "poly 8", 2,
+    { { apps::Dispatcher::mode_, 1 }, { apps::Dispatcher::num_voices_, 7 } } },
+  { &apps::Dispatcher::app_info_, "stack 8", 2,
+    { { apps::Dispatcher::mode_, 3 }, { apps::Dispatcher::num_voices_, 7 } } },
+};
+
+static uint32_t Percentile(const std::vector<uint32_t>& sorted, uint8_t p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  return sorted[(sorted.size() - 1) * p / 100];
+}
+
+static void Replay(
+    uint8_t app,
+    const Preset* preset,
+    const std::vector<host::TimedMessage>& stream) {
+  Harness::Init(app);
+  if (preset) {
+    for (uint8_t i = 0; i < preset->num_settings; ++i) {
+      App::SetParameter(preset->settings[i][0], preset->settings[i][1]);
+    }
+  }
+  Harness::Feed(stream);
+  Harness::RunUntil(host::Machine::input_end());
+  Harness::Drain(host::kCpuFrequency);
+  Harness::Collect();
+
+  char name[9] = "selector";
+  if (app) {
+    memset(name, 0, sizeof(name));
+    ResourcesManager::LoadStringResource(App::app_name(), name, 8);
+  }
+  host::Statistics& stats = Harness::statistics();
+  std::sort(stats.latencies.begin(), stats.latencies.end());
+  const double us = 1e6 / host::kCpuFrequency;
+  printf("%-9s %-8s %7zu %8.0f %8.0f %8.0f %8.0f %4d %6d %6d %6d\n",
+         name,
+         preset ? preset->name : "factory",
+         stats.latencies.size(),
+         Percentile(stats.latencies, 50) * us,
+         Percentile(stats.latencies, 90) * us,
+         Percentile(stats.latencies, 99) * us,
+         Percentile(stats.latencies, 100) * us,
+         stats.output_high_water,
+         stats.output_stalls,
+         stats.output_drops,
+         stats.input_overruns);
+}
+
+int main(int argc, char** argv) {
+  std::vector<host::TimedMessage> stream;
+  if (argc > 1) {
+    if (!host::ReadStandardMidiFile(argv[1], &stream)) {
+      fprintf(stderr, "Cannot read %s\n", argv[1]);
+      return 1;
+    }
+  } else {
+    host::GenerateDenseStream(20000, &stream);
+  }
+  printf("%zu messages, output buffer of %d bytes\n",
+         stream.size(), MidiHandler::OutputBuffer::capacity());
+  printf("%-9s %-8s %7s %8s %8s %8s %8s %4s %6s %6s %6s\n",
+         "app", "preset", "out", "p50", "p90", "p99", "max",
+         "hw", "stalls", "drops", "lost");
+  for (uint8_t app = 0; app < App::num_apps(); ++app) {
+    Replay(app, nullptr, stream);
+    for (const auto& preset : presets) {
+      if (Harness::app_index(preset.app) == app) {
+        Replay(app, &preset, stream);
+      }
+    }
+  }
+  printf("(latencies in us, from the end of an input message to the end of "
+         "the\nlast byte it sent)\n");
+  return 0;
+}
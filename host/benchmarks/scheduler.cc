@@ -0,0 +1,192 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Cost of the event scheduler, with a given number of live entries. Each tick
+// walks the due entries the way App::SendScheduledNotes does, advances the
+// scheduler, and schedules as many new events, in 1 to 96 ticks, as have
+// expired. The scheduler is compared with the one it replaced, which stored
+// absolute delays and decremented all of them on every tick.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "host/benchmarks/cycles.h"
+#include "midipal/event_scheduler.h"
+
+using namespace midipal;
+using host::Cycles;
+
+// The scheduler before delays were stored relative to the previous entry.
+class LegacyEventScheduler {
+ public:
+  static constexpr uint8_t numEntries = EventScheduler::numEntries;
+  static constexpr uint8_t kFreeSlot = 0xff;
+
+  struct Entry {
+    uint8_t note;
+    uint8_t velocity;
+    uint8_t when;
+    uint8_t next;
+    uint8_t tag;
+  };
+
+  static void Init() {
+    memset(entries_, kFreeSlot, sizeof(entries_));
+    root_ptr_ = 0;
+    size_ = 0;
+  }
+
+  static void Tick() {
+    while (!entries_[root_ptr_].when && root_ptr_) {
+      entries_[root_ptr_].note = kFreeSlot;
+      root_ptr_ = entries_[root_ptr_].next;
+      --size_;
+    }
+    uint8_t current = root_ptr_;
+    while (current) {
+      --entries_[current].when;
+      current = entries_[current].next;
+    }
+  }
+
+  static void Schedule(uint8_t note, uint8_t velocity, uint8_t when,
+                       uint8_t tag = 0) {
+    uint8_t free_slot = 0;
+    for (uint8_t i = 1; i < numEntries; ++i) {
+      if (entries_[i].note == kFreeSlot) {
+        free_slot = i;
+        break;
+      }
+    }
+    if (!free_slot) {
+      return;
+    }
+    ++size_;
+    entries_[free_slot].note = note;
+    entries_[free_slot].velocity = velocity;
+    entries_[free_slot].when = when;
+    entries_[free_slot].tag = tag;
+    if (!root_ptr_ || when < entries_[root_ptr_].when) {
+      entries_[free_slot].next = root_ptr_;
+      root_ptr_ = free_slot;
+    } else {
+      uint8_t insert_position = root_ptr_;
+      while (entries_[insert_position].next &&
+             when >= entries_[entries_[insert_position].next].when) {
+        insert_position = entries_[insert_position].next;
+      }
+      entries_[free_slot].next = entries_[insert_position].next;
+      entries_[insert_position].next = free_slot;
+    }
+  }
+
+  static uint8_t root() { return root_ptr_; }
+  static const Entry& entryAt(uint8_t address) { return entries_[address]; }
+  static uint8_t size() { return size_; }
+
+ private:
+  static Entry entries_[numEntries];
+  static uint8_t root_ptr_;
+  static uint8_t size_;
+};
+
+/* static */
+LegacyEventScheduler::Entry LegacyEventScheduler::entries_[numEntries];
+
+/* static */
+uint8_t LegacyEventScheduler::root_ptr_;
+
+/* static */
+uint8_t LegacyEventScheduler::size_;
+
+static const uint16_t kNumTicks = 20000;
+
+static uint32_t rng_state = 1;
+
+static uint8_t RandomDelay() {
+  rng_state = rng_state * 1664525L + 1013904223L;
+  return 1 + (rng_state >> 24) % 96;
+}
+
+struct Result {
+  double tick;  // Cycles per tick, walk of the due entries included.
+  double schedule;  // Cycles per scheduled event.
+};
+
+template<typename Scheduler>
+static Result Measure(uint8_t num_live_entries) {
+  rng_state = 1;
+  Scheduler::Init();
+  for (uint8_t i = 0; i < num_live_entries; ++i) {
+    Scheduler::Schedule(i, 100, RandomDelay());
+  }
+  uint64_t tick_cycles = 0;
+  uint64_t schedule_cycles = 0;
+  uint32_t num_scheduled = 0;
+  uint8_t sink = 0;
+  for (uint16_t t = 0; t < kNumTicks; ++t) {
+    uint64_t start = Cycles();
+    uint8_t num_due = 0;
+    uint8_t current = Scheduler::root();
+    while (current) {
+      const auto& entry = Scheduler::entryAt(current);
+      if (entry.when) {
+        break;
+      }
+      sink += entry.note;
+      ++num_due;
+      current = entry.next;
+    }
+    Scheduler::Tick();
+    uint64_t middle = Cycles();
+    for (uint8_t i = 0; i < num_due; ++i) {
+      Scheduler::Schedule(sink & 0x7f, 100, RandomDelay());
+    }
+    uint64_t end = Cycles();
+    tick_cycles += middle - start;
+    schedule_cycles += end - middle;
+    num_scheduled += num_due;
+  }
+  Result result;
+  result.tick = static_cast<double>(tick_cycles) / kNumTicks;
+  result.schedule = num_scheduled
+      ? static_cast<double>(schedule_cycles) / num_scheduled
+      : 0.0;
+  return result;
+}
+
+int main(int argc, char** argv) {
+#ifdef USE_TIMING_WHEEL_SCHEDULER
+  const char* name = "timing wheel";
+#else
+  const char* name = "relative delays";
+#endif  // USE_TIMING_WHEEL_SCHEDULER
+  printf("Host cycles per tick / per scheduled event, %d entries max.\n",
+         EventScheduler::numEntries - 1);
+  printf("%5s %20s %20s\n", "live", "legacy", name);
+  static const uint8_t sizes[] = { 8, 24, 48, 64, 80, 96 };
+  for (uint8_t size : sizes) {
+    if (size >= EventScheduler::numEntries) {
+      break;
+    }
+    Result legacy = Measure<LegacyEventScheduler>(size);
+    Result current = Measure<EventScheduler>(size);
+    printf("%5d %9.1f / %8.1f %9.1f / %8.1f\n",
+           size, legacy.tick, legacy.schedule, current.tick, current.schedule);
+  }
+  return 0;
+}
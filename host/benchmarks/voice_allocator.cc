@@ -0,0 +1,192 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+//
+// Cost of the voice allocator, for 1 to kMaxPolyphony voices, on a random
+// sequence of note ons and offs holding up to 4 notes more than there are
+// voices, so that voices are retriggered, reused and stolen. The allocator is
+// compared with the one it replaced, which scanned the pool and rewrote an
+// LRU array on every call; both must assign the same voices.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "host/benchmarks/cycles.h"
+#include "midipal/voice_allocator.h"
+
+using namespace midipal;
+using host::Cycles;
+
+// The allocator before voices were tracked with a bitmask and linked lists.
+class LegacyVoiceAllocator {
+ public:
+  static void Init() { size_ = 0; Clear(); }
+  static void set_size(uint8_t size) { size_ = size; }
+
+  static uint8_t NoteOn(uint8_t note) {
+    if (size_ == 0) {
+      return 0xff;
+    }
+    uint8_t voice = 0xff;
+    for (uint8_t i = 0; i < size_; ++i) {
+      if (pool_[i].note == note) {
+        voice = i;
+        break;
+      }
+    }
+    if (voice == 0xff) {
+      for (uint8_t i = 0; i < kMaxPolyphony; ++i) {
+        if (lru_[i] < size_ && !pool_[lru_[i]].active) {
+          voice = lru_[i];
+        }
+      }
+    }
+    if (voice == 0xff) {
+      for (uint8_t i = 0; i < kMaxPolyphony; ++i) {
+        if (lru_[i] < size_) {
+          voice = lru_[i];
+        }
+      }
+    }
+    pool_[voice].note = note;
+    pool_[voice].active = 1;
+    Touch(voice);
+    return voice;
+  }
+
+  static uint8_t NoteOff(uint8_t note) {
+    uint8_t voice = 0xff;
+    for (uint8_t i = 0; i < size_; ++i) {
+      if (pool_[i].note == note) {
+        voice = i;
+      }
+    }
+    if (voice != 0xff) {
+      pool_[voice].active = 0;
+      Touch(voice);
+    }
+    return voice;
+  }
+
+ private:
+  struct VoiceEntry {
+    uint8_t note;
+    uint8_t active;
+  };
+
+  static void Clear() {
+    memset(&pool_, 0, sizeof(pool_));
+    for (uint8_t i = 0; i < kMaxPolyphony; ++i) {
+      lru_[i] = kMaxPolyphony - i - 1;
+    }
+  }
+
+  static void Touch(uint8_t voice) {
+    int8_t source = kMaxPolyphony - 1;
+    int8_t destination = kMaxPolyphony - 1;
+    while (source >= 0) {
+      if (lru_[source] != voice) {
+        lru_[destination--] = lru_[source];
+      }
+      --source;
+    }
+    lru_[0] = voice;
+  }
+
+  static VoiceEntry pool_[kMaxPolyphony];
+  static uint8_t lru_[kMaxPolyphony];
+  static uint8_t size_;
+};
+
+/* static */
+LegacyVoiceAllocator::VoiceEntry LegacyVoiceAllocator::pool_[kMaxPolyphony];
+
+/* static */
+uint8_t LegacyVoiceAllocator::lru_[kMaxPolyphony];
+
+/* static */
+uint8_t LegacyVoiceAllocator::size_;
+
+static const uint16_t kNumEvents = 20000;
+
+struct Event {
+  uint8_t note;
+  bool on;
+};
+
+static void MakeEvents(uint8_t num_voices, std::vector<Event>* events) {
+  uint32_t rng_state = 1;
+  std::vector<uint8_t> held;
+  events->clear();
+  while (events->size() < kNumEvents) {
+    rng_state = rng_state * 1664525L + 1013904223L;
+    uint8_t r = rng_state >> 24;
+    if (held.size() < num_voices + 4u && (r & 1 || held.empty())) {
+      // Note 0 is avoided: the legacy allocator stores it in its unused
+      // voices.
+      uint8_t note = 36 + (r >> 1) % 48;
+      events->push_back({ note, true });
+      held.push_back(note);
+    } else {
+      uint8_t index = (r >> 1) % held.size();
+      events->push_back({ held[index], false });
+      held.erase(held.begin() + index);
+    }
+  }
+}
+
+// Returns the average cycles per event, and the voices assigned.
+template<typename Allocator>
+static double Measure(
+    uint8_t num_voices,
+    const std::vector<Event>& events,
+    std::vector<uint8_t>* voices) {
+  Allocator::Init();
+  Allocator::set_size(num_voices);
+  voices->resize(events.size());
+  uint64_t start = Cycles();
+  for (size_t i = 0; i < events.size(); ++i) {
+    (*voices)[i] = events[i].on
+        ? Allocator::NoteOn(events[i].note)
+        : Allocator::NoteOff(events[i].note);
+  }
+  uint64_t end = Cycles();
+  return static_cast<double>(end - start) / events.size();
+}
+
+int main(int argc, char** argv) {
+  printf("Host cycles per note on or off.\n");
+  printf("%6s %10s %10s %10s\n", "voices", "legacy", "current", "mismatch");
+  std::vector<Event> events;
+  std::vector<uint8_t> legacy_voices;
+  std::vector<uint8_t> voices;
+  for (uint8_t n = 1; n <= kMaxPolyphony; ++n) {
+    MakeEvents(n, &events);
+    double legacy = Measure<LegacyVoiceAllocator>(n, events, &legacy_voices);
+    double current = Measure<VoiceAllocator>(n, events, &voices);
+    uint32_t mismatches = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+      if (voices[i] != legacy_voices[i]) {
+        ++mismatches;
+      }
+    }
+    printf("%6d %10.1f %10.1f %10u\n", n, legacy, current, mismatches);
+  }
+  return 0;
+}
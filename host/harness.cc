@@ -0,0 +1,408 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Host harness.
+
+#include "host/harness.h"
+
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+
+#include <deque>
+
+#include "avrlib/serial.h"
+#include "avrlib/timer.h"
+
+#include "midipal/app.h"
+#include "midipal/app_registry.h"
+#include "midipal/apps/scale_processor.h"
+#include "midipal/clock.h"
+#include "midipal/engine.h"
+#include "midipal/event_scheduler.h"
+#include "midipal/hardware_config.h"
+#include "midipal/midi_handler.h"
+#include "midipal/note_stack.h"
+#include "midipal/pipeline.h"
+#include "midipal/settings_store.h"
+#include "midipal/ui.h"
+
+namespace host {
+
+using namespace avrlib;
+using namespace midipal;
+
+using MidiIo = Serial<MidiPort, 31250, POLLED, POLLED>;
+
+// Timer 1 counts CPU cycles divided by 64.
+static const uint32_t kTimer1Prescaler = 64;
+
+// Output of an input message: it has left the chip once the output buffer
+// has been read up to end.
+struct PendingLatency {
+  uint32_t end;
+  uint64_t arrival;
+};
+
+static uint64_t next_timer2;
+static uint64_t next_timer1;
+static uint8_t sub_clock;
+// Interrupt handlers being run, and whether the firmware is running at all:
+// between two steps of the harness, nothing can be interrupted.
+static bool in_timer1;
+static bool in_timer2;
+static bool running;
+static std::deque<PendingLatency> pending_latencies;
+static Statistics stats;
+
+static inline void CheckInputErrors() {
+  uint8_t status = UCSR0A;
+  if (status & bitFlag8(DOR0)) {
+    Engine::CountInputError(INPUT_ERROR_OVERRUN);
+    if (stats.input_overruns != 0xffff) {
+      ++stats.input_overruns;
+    }
+  }
+  if (status & bitFlag8(FE0)) {
+    Engine::CountInputError(INPUT_ERROR_FRAMING);
+  }
+}
+
+/* static */
+void Harness::Init(uint8_t app_index) {
+#ifdef APP_PIPELINE
+  // The note stacks of the previous boot still hold nodes of the pool, which
+  // is about to be reset: empty them first, as relaunching their app would.
+  NoteStack::Clear();
+  apps::ScaleProcessor::OnInit();
+#endif  // APP_PIPELINE
+
+  Machine::Reset();
+  memset(host_eeprom, 0xff, sizeof(host_eeprom));
+  memset(host_eeprom_writes, 0, sizeof(host_eeprom_writes));
+  next_timer2 = kTimer2Period;
+  next_timer1 = 0;
+  sub_clock = 0;
+  in_timer1 = false;
+  in_timer2 = false;
+  running = false;
+  host_interrupt_hook = &Harness::Preempt;
+  pending_latencies.clear();
+
+  // Factory reset, as done by the app selector, with app_index selected.
+  for (uint8_t i = 1; i < App::num_apps(); ++i) {
+    App::Launch(i);
+    App::ResetToFactorySettings();
+  }
+  App::Launch(0);
+  App::SetParameter(0, app_index);
+  App::SaveSettings();
+  SettingsStore::Flush();
+
+#ifndef APP_PIPELINE
+  // The note tables are in the arena, which the factory settings have just
+  // overwritten: start from zeroed RAM, as after a reset.
+  memset(app_arena, 0, AppRegistry::arena_size);
+#endif  // APP_PIPELINE
+
+  // Same as Init() in midipal.cc.
+  UCSR0B = 0;
+  NotePool::Init();
+  NoteStack::Init();
+  note_map().Clear();
+  EventScheduler::Init();
+
+  App::Launch(App::num_apps() - 1_u8);
+  App::LoadSettings();
+
+  App::Launch(0);
+  App::Init();
+
+  auto launch_app = App::GetParameter(0);
+  if (launch_app >= App::num_apps()) {
+    launch_app = 0;
+    App::SetParameter(0, launch_app);
+  }
+#ifdef APP_PIPELINE
+  Pipeline::Init();
+#endif  // APP_PIPELINE
+  App::Launch(launch_app);
+
+  Ui::Init();
+  Clock::Init();
+  PwmChannel1A::set_frequency(6510);
+  next_timer1 = (Machine::timer1_period() + 1) * kTimer1Prescaler;
+  App::Init();
+  MidiIo::Init();
+  ResetStatistics();
+}
+
+/* static */
+void Harness::Feed(const uint8_t* bytes, uint16_t size) {
+  uint64_t time = Machine::input_end();
+  if (time < Machine::now()) {
+    time = Machine::now();
+  }
+  while (size--) {
+    time += kUartByteTime;
+    Machine::QueueInput(time, *bytes++);
+  }
+}
+
+/* static */
+void Harness::Feed(const std::vector<TimedMessage>& messages) {
+  for (const auto& message : messages) {
+    uint64_t time = Machine::input_end();
+    if (time < message.time) {
+      time = message.time;
+    }
+    for (uint8_t byte : message.bytes) {
+      time += kUartByteTime;
+      Machine::QueueInput(time, byte);
+    }
+  }
+}
+
+/* static */
+uint8_t Harness::app_index(const AppInfo* info) {
+  for (uint8_t i = 0; i < AppRegistry::size; ++i) {
+    if (AppRegistry::info[i] == info) {
+      return i;
+    }
+  }
+  return 0xff;
+}
+
+/* static */
+void Harness::RunUntil(uint64_t time) {
+  while (true) {
+    uint64_t next = next_timer2;
+    if (next_timer1 < next) {
+      next = next_timer1;
+    }
+#ifdef ENABLE_MIDI_RX_ISR
+    bool receive = Machine::next_input_time() < next;
+    if (receive) {
+      next = Machine::next_input_time();
+    }
+#endif  // ENABLE_MIDI_RX_ISR
+    if (next > time) {
+      break;
+    }
+    Machine::AdvanceTo(next);
+#ifdef ENABLE_MIDI_RX_ISR
+    if (receive) {
+      // USART_RX_vect.
+      Machine::input_readable();
+      CheckInputErrors();
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+      Engine::PostEvent(EVENT_INPUT_BYTE, Machine::ReadInput());
+#else
+      Engine::BufferInputByte(Machine::ReadInput());
+#endif  // ENABLE_MAIN_LOOP_EVENTS
+      continue;
+    }
+#endif  // ENABLE_MIDI_RX_ISR
+    running = true;
+    if (next == next_timer1) {
+      RunTimer1();
+    } else {
+      RunTimer2();
+      MainLoop();
+    }
+    running = false;
+  }
+  Machine::AdvanceTo(time);
+}
+
+/* static */
+void Harness::Preempt() {
+  if (!running) {
+    return;
+  }
+  // The code which has just enabled interrupts was spinning on the UART:
+  // the timer interrupts which have fallen due meanwhile preempt it, timer 1
+  // first, as it has the highest priority. An interrupt does not preempt
+  // itself.
+  while (true) {
+    if (!in_timer1 && next_timer1 <= Machine::now()) {
+      RunTimer1();
+    } else if (!in_timer2 && next_timer2 <= Machine::now()) {
+      RunTimer2();
+    } else {
+      break;
+    }
+  }
+}
+
+/* static */
+void Harness::RunTimer1() {
+  // ISR_BLOCK: interrupts stay disabled until it returns.
+  in_timer1 = true;
+  uint8_t sreg = SREG;
+  cli();
+  Timer1();
+  next_timer1 += (Machine::timer1_period() + 1) * kTimer1Prescaler;
+  // Interrupts which should have fired while the firmware was busy with
+  // interrupts disabled, or spinning on the UART, are lost but one.
+  while (next_timer1 + (Machine::timer1_period() + 1) * kTimer1Prescaler <=
+         Machine::now()) {
+    next_timer1 += (Machine::timer1_period() + 1) * kTimer1Prescaler;
+  }
+  in_timer1 = false;
+  SREG = sreg;
+}
+
+/* static */
+void Harness::RunTimer2() {
+  // ISR_NOBLOCK: timer 1 can preempt it.
+  in_timer2 = true;
+  uint8_t sreg = SREG;
+  sei();
+  Timer2();
+  MatchLatencies();
+  next_timer2 += kTimer2Period;
+  while (next_timer2 + kTimer2Period <= Machine::now()) {
+    next_timer2 += kTimer2Period;
+  }
+  in_timer2 = false;
+  SREG = sreg;
+}
+
+/* static */
+void Harness::Drain(uint64_t timeout) {
+  uint64_t deadline = Machine::now() + timeout;
+  while (Machine::now() < deadline) {
+    Run(kTimer2Period);
+    if (Machine::next_input_time() == UINT64_MAX &&
+        !MidiInput::Buffer::readable() &&
+        !midipal::EventQueue::Buffer::readable() &&
+        !MidiHandler::OutputBuffer::readable() &&
+        !RealtimeOutput::Buffer::readable()) {
+      break;
+    }
+  }
+  // Last byte on the wire.
+  Run(kUartByteTime);
+}
+
+/* static */
+std::vector<TimedByte> Harness::Collect() {
+  std::vector<TimedByte> output;
+  output.swap(Machine::output());
+  return output;
+}
+
+/* static */
+void Harness::ResetStatistics() {
+  stats.latencies.clear();
+  stats.input_overruns = 0;
+  App::ResetOutputStatistics();
+}
+
+/* static */
+Statistics& Harness::statistics() {
+  stats.output_high_water = App::output_high_water();
+  stats.output_stalls = App::output_stalls();
+  stats.output_drops = App::output_drops();
+  return stats;
+}
+
+/* static */
+void Harness::ParseInputByte(uint8_t byte, uint64_t arrival) {
+  uint32_t written = MidiHandler::OutputBuffer::num_written();
+  if (Engine::PushInputByte(byte)) {
+    LedIn::High();
+  }
+  if (MidiHandler::OutputBuffer::num_written() != written) {
+    PendingLatency p = { MidiHandler::OutputBuffer::num_written(), arrival };
+    pending_latencies.push_back(p);
+  }
+}
+
+/* static */
+void Harness::MatchLatencies() {
+  uint32_t read = MidiHandler::OutputBuffer::num_read();
+  while (!pending_latencies.empty() &&
+         static_cast<int32_t>(read - pending_latencies.front().end) >= 0) {
+    uint64_t sent = Machine::now() + kUartByteTime;
+    stats.latencies.push_back(sent - pending_latencies.front().arrival);
+    pending_latencies.pop_front();
+  }
+}
+
+// Same as ISR(TIMER2_OVF_vect) in midipal.cc.
+/* static */
+void Harness::Timer2() {
+#if defined(ENABLE_MAIN_LOOP_EVENTS)
+#ifndef ENABLE_MIDI_RX_ISR
+  if (MidiIo::readable()) {
+    CheckInputErrors();
+    Engine::PostEvent(EVENT_INPUT_BYTE, MidiIo::ImmediateRead());
+  }
+#endif  // ENABLE_MIDI_RX_ISR
+#elif defined(ENABLE_MIDI_RX_ISR)
+  if (MidiInput::Buffer::readable()) {
+    if (Engine::ProcessInputBuffer()) {
+      LedIn::High();
+    }
+  }
+#else
+  if (MidiIo::readable()) {
+    CheckInputErrors();
+    uint64_t arrival = Machine::next_input_time();
+    ParseInputByte(MidiIo::ImmediateRead(), arrival);
+  }
+#endif  // ENABLE_MIDI_RX_ISR
+
+  App::TransmitOutputByte();
+#ifndef ENABLE_MAIN_LOOP_EVENTS
+  App::FlushPendingMessage();
+
+  Engine::ProcessClockTicks();
+#endif  // ENABLE_MAIN_LOOP_EVENTS
+
+  sub_clock = byteAnd(sub_clock + 1, 3);
+  if (byteAnd(sub_clock, 1) == 0) {
+    Ui::Poll();
+    if (byteAnd(sub_clock, 3) == 0) {
+      TickSystemClock();
+      LedOut::Low();
+      LedIn::Low();
+    }
+  }
+}
+
+// Same as ISR(TIMER1_COMPA_vect) in midipal.cc.
+/* static */
+void Harness::Timer1() {
+  PwmChannel1A::set_frequency(Clock::Tick());
+  Engine::OnInternalClockTick();
+}
+
+// Same as the body of the loop in main() in midipal.cc.
+/* static */
+void Harness::MainLoop() {
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+  if (Engine::ProcessEvents()) {
+    LedIn::High();
+  }
+#endif  // ENABLE_MAIN_LOOP_EVENTS
+  Ui::DoEvents();
+  SettingsStore::Commit();
+}
+
+}  // namespace host
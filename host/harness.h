@@ -0,0 +1,112 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Runs the firmware on the host: boots it like Init() in midipal.cc, then
+// plays the part of the interrupt handlers and of the main loop, against the
+// machine model. Bytes are fed to the MIDI input, time is advanced, and the
+// bytes sent to the MIDI output are collected.
+
+#ifndef HOST_HARNESS_H_
+#define HOST_HARNESS_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "avrlib/base.h"
+
+#include "host/machine.h"
+#include "host/streams.h"
+
+namespace midipal {
+struct AppInfo;
+}  // namespace midipal
+
+namespace host {
+
+// Input-to-output latencies and state of the output path, since the last
+// call to Harness::ResetStatistics().
+struct Statistics {
+  // For each input message which has sent something out immediately, time
+  // between the end of its reception and the end of the transmission of the
+  // last byte it has sent. Messages sent later, by the scheduler or on clock
+  // ticks, are not counted.
+  std::vector<uint32_t> latencies;
+  uint8_t output_high_water;
+  uint16_t output_stalls;
+  uint16_t output_drops;
+  uint16_t input_overruns;
+};
+
+class Harness {
+ public:
+  // Resets the machine, restores the factory settings of all the apps, and
+  // boots the firmware with app_index as the active app.
+  static void Init(uint8_t app_index);
+
+  // Queues bytes on the MIDI input, back to back at wire speed, starting
+  // after the last byte already queued or now, whichever is later.
+  static void Feed(const uint8_t* bytes, uint16_t size);
+  static void Feed(uint8_t a, uint8_t b, uint8_t c) {
+    uint8_t bytes[3] = { a, b, c };
+    Feed(bytes, 3);
+  }
+  // Queues timed messages, each starting at its time or after the byte
+  // queued before it, whichever is later - as a MIDI interface would send
+  // them.
+  static void Feed(const std::vector<TimedMessage>& messages);
+  // Queues a byte which finishes arriving at time.
+  static void FeedAt(uint64_t time, uint8_t byte) {
+    Machine::QueueInput(time, byte);
+  }
+
+  // Runs the interrupt handlers and the main loop until time.
+  static void RunUntil(uint64_t time);
+  static void Run(uint64_t cycles) {
+    RunUntil(Machine::now() + cycles);
+  }
+  // Runs until all the input has been received, parsed, and the output it
+  // caused has been sent, or for at most timeout cycles.
+  static void Drain(uint64_t timeout);
+
+  // Returns and forgets the bytes sent to the MIDI output.
+  static std::vector<TimedByte> Collect();
+
+  // Index of an app in the registry, or 0xff if it is not built in.
+  static uint8_t app_index(const midipal::AppInfo* info);
+
+  static void ResetStatistics();
+  static Statistics& statistics();
+
+  // Called when the firmware enables interrupts.
+  static void Preempt();
+
+ private:
+  static void RunTimer1();
+  static void RunTimer2();
+  static void Timer2();
+  static void Timer1();
+  static void MainLoop();
+  static void ParseInputByte(uint8_t byte, uint64_t arrival);
+  static void MatchLatencies();
+
+  DISALLOW_COPY_AND_ASSIGN(Harness);
+};
+
+}  // namespace host
+
+#endif  // HOST_HARNESS_H_
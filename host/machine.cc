@@ -0,0 +1,104 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Model of the chip.
+
+#include "host/machine.h"
+
+#include <avr/io.h>
+
+namespace host {
+
+/* static */
+uint64_t Machine::now_;
+
+/* static */
+std::deque<TimedByte> Machine::input_;
+
+/* static */
+uint64_t Machine::input_end_;
+
+/* static */
+uint64_t Machine::output_busy_until_;
+
+/* static */
+bool Machine::instant_output_;
+
+/* static */
+std::vector<TimedByte> Machine::output_;
+
+/* static */
+uint16_t Machine::timer1_period_;
+
+/* static */
+void Machine::Reset() {
+  now_ = 0;
+  input_.clear();
+  input_end_ = 0;
+  output_busy_until_ = 0;
+  instant_output_ = false;
+  output_.clear();
+  timer1_period_ = 0;
+  UCSR0A = 0;
+}
+
+/* static */
+void Machine::QueueInput(uint64_t time, uint8_t byte) {
+  TimedByte b = { time, byte };
+  input_.push_back(b);
+  if (time > input_end_) {
+    input_end_ = time;
+  }
+}
+
+/* static */
+bool Machine::input_readable() {
+  // The UART holds two received bytes; a third one arriving before the
+  // first is read is lost, and flagged as a data overrun.
+  while (input_.size() > 2 && input_[2].time <= now_) {
+    input_.erase(input_.begin() + 2);
+    UCSR0A |= 1 << DOR0;
+  }
+  return !input_.empty() && input_.front().time <= now_;
+}
+
+/* static */
+uint8_t Machine::ReadInput() {
+  uint8_t byte = input_.front().byte;
+  input_.pop_front();
+  UCSR0A &= ~(1 << DOR0);
+  return byte;
+}
+
+/* static */
+bool Machine::output_writable() {
+  if (instant_output_ || now_ >= output_busy_until_) {
+    return true;
+  }
+  // The firmware is spinning on the UART.
+  now_ += kBusyPollTime;
+  return false;
+}
+
+/* static */
+void Machine::WriteOutput(uint8_t byte) {
+  TimedByte b = { now_, byte };
+  output_.push_back(b);
+  output_busy_until_ = now_ + kUartByteTime;
+}
+
+}  // namespace host
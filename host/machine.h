@@ -0,0 +1,90 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Model of the parts of the chip the firmware talks to: a clock counting CPU
+// cycles, the MIDI UART, and the period of timer 1. The firmware only sees it
+// through the avr/ and avrlib/ stand-ins; the harness drives it.
+
+#ifndef HOST_MACHINE_H_
+#define HOST_MACHINE_H_
+
+#include <stdint.h>
+
+#include <deque>
+#include <vector>
+
+namespace host {
+
+static const uint32_t kCpuFrequency = 20000000;
+// Timer 2: /8 prescaler, phase correct PWM.
+static const uint32_t kTimer2Period = 8 * 510;
+// 10 bits at 31250 baud.
+static const uint32_t kUartByteTime = kCpuFrequency / 3125;
+// Cost of one poll of a busy UART, in the spin loops of the firmware.
+static const uint32_t kBusyPollTime = 16;
+
+struct TimedByte {
+  uint64_t time;
+  uint8_t byte;
+};
+
+class Machine {
+ public:
+  static void Reset();
+
+  static uint64_t now() { return now_; }
+  // Time never goes back: moving to an earlier time does nothing.
+  static void AdvanceTo(uint64_t time) {
+    if (time > now_) {
+      now_ = time;
+    }
+  }
+
+  // A byte which has finished arriving on the MIDI input at time.
+  static void QueueInput(uint64_t time, uint8_t byte);
+  // Time at which the last queued input byte has arrived.
+  static uint64_t input_end() { return input_end_; }
+  // Time at which the next input byte finishes arriving, or UINT64_MAX.
+  static uint64_t next_input_time() {
+    return input_.empty() ? UINT64_MAX : input_.front().time;
+  }
+  static bool input_readable();
+  static uint8_t ReadInput();
+
+  // With instant output, the UART is always ready to send.
+  static void set_instant_output(bool instant) { instant_output_ = instant; }
+  static bool output_writable();
+  static void WriteOutput(uint8_t byte);
+  // Bytes written to the UART, with the time at which they were written.
+  static std::vector<TimedByte>& output() { return output_; }
+
+  static uint16_t timer1_period() { return timer1_period_; }
+  static void set_timer1_period(uint16_t period) { timer1_period_ = period; }
+
+ private:
+  static uint64_t now_;
+  static std::deque<TimedByte> input_;
+  static uint64_t input_end_;
+  static uint64_t output_busy_until_;
+  static bool instant_output_;
+  static std::vector<TimedByte> output_;
+  static uint16_t timer1_period_;
+};
+
+}  // namespace host
+
+#endif  // HOST_MACHINE_H_
@@ -0,0 +1,258 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Input streams for the benchmarks.
+
+#include "host/streams.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "host/machine.h"
+
+namespace host {
+
+namespace {
+
+struct TrackEvent {
+  uint32_t tick;
+  uint32_t order;
+  uint32_t tempo;  // Microseconds per quarter note, or 0.
+  std::vector<uint8_t> bytes;
+};
+
+class Reader {
+ public:
+  Reader(const std::vector<uint8_t>& data, size_t begin, size_t end)
+      : data_(data), position_(begin), end_(end) { }
+
+  bool done() const { return position_ >= end_; }
+  bool ok() const { return ok_; }
+  size_t position() const { return position_; }
+
+  uint8_t Byte() {
+    if (position_ >= end_) {
+      ok_ = false;
+      return 0;
+    }
+    return data_[position_++];
+  }
+  uint32_t Big(uint8_t size) {
+    uint32_t value = 0;
+    while (size--) {
+      value = value << 8 | Byte();
+    }
+    return value;
+  }
+  uint32_t Variable() {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+      uint8_t b = Byte();
+      value = value << 7 | (b & 0x7f);
+      if (!(b & 0x80)) {
+        break;
+      }
+    }
+    return value;
+  }
+  void Skip(uint32_t size) { position_ += size; }
+
+ private:
+  const std::vector<uint8_t>& data_;
+  size_t position_;
+  size_t end_;
+  bool ok_ = true;
+};
+
+bool ReadTrack(Reader* reader, std::vector<TrackEvent>* events) {
+  uint32_t tick = 0;
+  uint8_t running_status = 0;
+  while (!reader->done() && reader->ok()) {
+    tick += reader->Variable();
+    uint8_t status = reader->Byte();
+    TrackEvent event = { tick, static_cast<uint32_t>(events->size()), 0, {} };
+    if (status == 0xff) {
+      uint8_t type = reader->Byte();
+      uint32_t size = reader->Variable();
+      if (type == 0x51 && size == 3) {
+        event.tempo = reader->Big(3);
+        events->push_back(event);
+      } else {
+        reader->Skip(size);
+      }
+      if (type == 0x2f) {
+        break;
+      }
+      continue;
+    } else if (status == 0xf0 || status == 0xf7) {
+      uint32_t size = reader->Variable();
+      if (status == 0xf0) {
+        event.bytes.push_back(0xf0);
+      }
+      for (uint32_t i = 0; i < size; ++i) {
+        event.bytes.push_back(reader->Byte());
+      }
+      events->push_back(event);
+      continue;
+    }
+    uint8_t first_data = 0;
+    bool has_first_data = false;
+    if (status < 0x80) {
+      if (!running_status) {
+        return false;
+      }
+      first_data = status;
+      has_first_data = true;
+      status = running_status;
+    } else {
+      running_status = status;
+    }
+    uint8_t type = status & 0xf0;
+    uint8_t size = (type == 0xc0 || type == 0xd0) ? 1 : 2;
+    event.bytes.push_back(status);
+    for (uint8_t i = 0; i < size; ++i) {
+      if (i == 0 && has_first_data) {
+        event.bytes.push_back(first_data);
+      } else {
+        event.bytes.push_back(reader->Byte());
+      }
+    }
+    events->push_back(event);
+  }
+  return reader->ok();
+}
+
+}  // namespace
+
+bool ReadStandardMidiFile(
+    const char* path,
+    std::vector<TimedMessage>* messages) {
+  FILE* fp = fopen(path, "rb");
+  if (!fp) {
+    return false;
+  }
+  std::vector<uint8_t> data;
+  uint8_t buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+    data.insert(data.end(), buffer, buffer + size);
+  }
+  fclose(fp);
+
+  Reader header(data, 0, data.size());
+  if (header.Big(4) != 0x4d546864) {  // MThd
+    return false;
+  }
+  uint32_t header_size = header.Big(4);
+  header.Big(2);  // Format.
+  uint16_t num_tracks = header.Big(2);
+  int16_t division = header.Big(2);
+  header.Skip(header_size - 6);
+
+  std::vector<TrackEvent> events;
+  size_t position = header.position();
+  for (uint16_t track = 0; track < num_tracks; ++track) {
+    Reader chunk(data, position, data.size());
+    uint32_t id = chunk.Big(4);
+    uint32_t chunk_size = chunk.Big(4);
+    if (!chunk.ok()) {
+      return false;
+    }
+    size_t begin = chunk.position();
+    size_t end = std::min(begin + chunk_size, data.size());
+    position = end;
+    if (id != 0x4d54726b) {  // MTrk
+      continue;
+    }
+    std::vector<TrackEvent> track_events;
+    Reader reader(data, begin, end);
+    if (!ReadTrack(&reader, &track_events)) {
+      return false;
+    }
+    for (auto& e : track_events) {
+      e.order = events.size();
+      events.push_back(e);
+    }
+  }
+  std::stable_sort(
+      events.begin(), events.end(),
+      [](const TrackEvent& a, const TrackEvent& b) { return a.tick < b.tick; });
+
+  // Ticks to CPU cycles, following the tempo changes. With a SMPTE division,
+  // the tick duration is fixed.
+  double cycles_per_tick;
+  if (division < 0) {
+    uint8_t frames_per_second = -(division >> 8);
+    uint8_t ticks_per_frame = division & 0xff;
+    cycles_per_tick = static_cast<double>(kCpuFrequency) /
+        (frames_per_second * ticks_per_frame);
+  } else {
+    cycles_per_tick = 500000.0 * kCpuFrequency / 1e6 / division;
+  }
+  double time = 0.0;
+  uint32_t last_tick = 0;
+  messages->clear();
+  for (const auto& e : events) {
+    time += (e.tick - last_tick) * cycles_per_tick;
+    last_tick = e.tick;
+    if (e.tempo && division > 0) {
+      cycles_per_tick = e.tempo * (kCpuFrequency / 1e6) / division;
+    }
+    if (!e.bytes.empty()) {
+      TimedMessage m = { static_cast<uint64_t>(time), e.bytes };
+      messages->push_back(m);
+    }
+  }
+  return true;
+}
+
+void GenerateDenseStream(
+    uint32_t duration_ms,
+    std::vector<TimedMessage>* messages) {
+  static const uint8_t chords[4][3] = {
+    { 48, 52, 55 }, { 45, 48, 52 }, { 41, 45, 48 }, { 43, 47, 50 }
+  };
+  static const uint8_t melody[8] = { 72, 74, 76, 79, 77, 76, 74, 71 };
+  // 140 BPM: a sixteenth note lasts 107ms.
+  const uint64_t sixteenth = kCpuFrequency * 60ULL / 140 / 4;
+  const uint64_t end = kCpuFrequency / 1000ULL * duration_ms;
+  messages->clear();
+  uint32_t step = 0;
+  for (uint64_t t = 0; t < end; t += sixteenth, ++step) {
+    const uint8_t* chord = chords[(step / 16) % 4];
+    if (step % 2 == 0) {
+      for (uint8_t i = 0; i < 3; ++i) {
+        messages->push_back({ t, { 0x90, chord[i], 90 } });
+      }
+    }
+    uint8_t note = melody[step % 8];
+    messages->push_back({ t + sixteenth / 8, { 0x90, note, 110 } });
+    messages->push_back({ t + sixteenth / 4, { 0xb0, 1,
+        static_cast<uint8_t>((step * 5) & 0x7f) } });
+    messages->push_back({ t + sixteenth / 2, { 0xb0, 1,
+        static_cast<uint8_t>((step * 5 + 2) & 0x7f) } });
+    messages->push_back({ t + sixteenth * 7 / 8, { 0x80, note, 0 } });
+    if (step % 2 == 1) {
+      for (uint8_t i = 0; i < 3; ++i) {
+        messages->push_back({ t + sixteenth * 15 / 16, { 0x80, chord[i], 0 } });
+      }
+    }
+  }
+}
+
+}  // namespace host
@@ -0,0 +1,47 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Input streams for the benchmarks: Standard MIDI Files, and a synthetic dense
+// keyboard performance for when no file is given.
+
+#ifndef HOST_STREAMS_H_
+#define HOST_STREAMS_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace host {
+
+struct TimedMessage {
+  uint64_t time;  // In CPU cycles.
+  std::vector<uint8_t> bytes;
+};
+
+// Reads a Standard MIDI File of format 0 or 1, merging its tracks. Meta events
+// are dropped, SysEx events keep their 0xf0. Returns false if the file cannot
+// be read or parsed.
+bool ReadStandardMidiFile(const char* path, std::vector<TimedMessage>* messages);
+
+// Two-handed playing on channel 1, as dense as a keyboard player gets: 3-note
+// chords on every eighth note, a sixteenth note melody, and a mod wheel
+// sweep, at 140 BPM.
+void GenerateDenseStream(uint32_t duration_ms, std::vector<TimedMessage>* messages);
+
+}  // namespace host
+
+#endif  // HOST_STREAMS_H_
@@ -20,6 +20,8 @@
 #ifndef MIDI_MIDI_H_
 #define MIDI_MIDI_H_
 
+#include <avr/pgmspace.h>
+
 namespace midi {
 
 constexpr uint8_t kBankLsb = 0x20;
@@ -72,21 +74,55 @@ struct MidiDevice {
   static void Start() { }
   static void Continue() { }
   static void Stop() { }
+  // Song position, in MIDI beats (sixteenth notes) since the start of the
+  // song.
+  static void SongPosition(uint16_t position) { }
+  // MIDI time code quarter frame: piece number in the high nibble, value in
+  // the low nibble.
+  static void QuarterFrame(uint8_t data) { }
   static void ActiveSensing() { }
   static void Reset() { }
 
   static uint8_t CheckChannel(uint8_t channel) { return 1; }
+  // Devices overriding RawByte can turn it off at run time.
+  static uint8_t CheckRawByte() { return 1; }
   static void RawByte(uint8_t byte) { }
   static void RawMidiData(uint8_t status, uint8_t* data, uint8_t data_size) { }
 };
 
+// Number of data bytes following a status byte, indexed by its high nibble
+// for channel messages...
+static constexpr uint8_t kChannelMessageDataSize[16] PROGMEM = {
+  0, 0, 0, 0, 0, 0, 0, 0,
+  2, 2, 2, 2, 1, 1, 2, 0
+};
+
+// ...and by its low nibble for system messages. A SysEx start is followed by
+// data bytes parsed one by one.
+static constexpr uint8_t kSystemMessageDataSize[16] PROGMEM = {
+  1, 1, 2, 1, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0
+};
+
 template<typename Device>
 class MidiStreamParser {
  public:
   MidiStreamParser();
   void PushByte(uint8_t byte);
+  void PushBytes(const uint8_t* bytes, uint8_t size) {
+    while (size--) {
+      PushByte(*bytes++);
+    }
+  }
+  // Calls the handlers of the device for a message which does not need to be
+  // parsed - status byte and data bytes - as PushByte does once it has
+  // received the last byte of a message.
+  static void Dispatch(uint8_t status, uint8_t* data, uint8_t data_size);
 
  private:
+  // Devices which do not override RawByte do not pay for the call.
+  static constexpr bool kHasRawByte = &Device::RawByte != &MidiDevice::RawByte;
+
   void MessageReceived(uint8_t status);
  
   uint8_t running_status_;
@@ -108,35 +144,20 @@ template<typename Device>
 void MidiStreamParser<Device>::PushByte(uint8_t byte) {
   // Realtime messages are immediately passed-through, and do not modify the
   // state of the parser.
-  Device::RawByte(byte);
+  if (kHasRawByte && Device::CheckRawByte()) {
+    Device::RawByte(byte);
+  }
   if (byte >= 0xf8) {
     MessageReceived(byte);
   } else {
     if (byte >= 0x80) {
-      uint8_t hi = byte & 0xf0;
-      uint8_t lo = byte & 0x0f;
       data_size_ = 0;
-      expected_data_size_ = 1;
-      switch (hi) {
-        case 0x80:
-        case 0x90:
-        case 0xa0:
-        case 0xb0:
-          expected_data_size_ = 2;
-          break;
-        case 0xc0:
-        case 0xd0:
-          break;  // default data size of 1.
-        case 0xe0:
-          expected_data_size_ = 2;
-          break;
-        case 0xf0:
-          if (lo > 0 && lo < 3) {
-            expected_data_size_ = 2;
-          } else if (lo >= 4) {
-            expected_data_size_ = 0;
-          }
-          break;
+      if (byte >= 0xf0) {
+        expected_data_size_ = pgm_read_byte(
+            kSystemMessageDataSize + (byte & 0x0f));
+      } else {
+        expected_data_size_ = pgm_read_byte(
+            kChannelMessageDataSize + (byte >> 4));
       }
       if (byte == 0xf7) {
         if (running_status_ == 0xf0) {
@@ -165,8 +186,15 @@ void MidiStreamParser<Device>::PushByte(uint8_t byte) {
 
 template<typename Device>
 void MidiStreamParser<Device>::MessageReceived(uint8_t status) {
+  Dispatch(status, data_, data_size_);
+}
+
+template<typename Device>
+/* static */
+void MidiStreamParser<Device>::Dispatch(
+    uint8_t status, uint8_t* data, uint8_t data_size) {
   if (!status) {
-    Device::BozoByte(data_[0]);
+    Device::BozoByte(data[0]);
   }
 
   uint8_t hi = status & 0xf0;
@@ -175,52 +203,56 @@ void MidiStreamParser<Device>::MessageReceived(uint8_t status) {
   // If this is a channel-specific message, check first that the receiver is
   // tuned to this channel.
   if (hi != 0xf0 && !Device::CheckChannel(lo)) {
-    Device::RawMidiData(status, data_, data_size_);
+    Device::RawMidiData(status, data, data_size);
     return;
   }
   if (status != 0xf0 && status != 0xf7) {
-    Device::RawMidiData(status, data_, data_size_);
+    Device::RawMidiData(status, data, data_size);
   }
   switch (hi) {
     case 0x80:
-      Device::NoteOff(lo, data_[0], data_[1]);
+      Device::NoteOff(lo, data[0], data[1]);
       break;
 
     case 0x90:
-      if (data_[1]) {
-        Device::NoteOn(lo, data_[0], data_[1]);
+      if (data[1]) {
+        Device::NoteOn(lo, data[0], data[1]);
       } else {
-        Device::NoteOff(lo, data_[0], 0);
+        Device::NoteOff(lo, data[0], 0);
       }
       break;
 
     case 0xa0:
-      Device::Aftertouch(lo, data_[0], data_[1]);
+      Device::Aftertouch(lo, data[0], data[1]);
       break;
 
     case 0xb0:
-      Device::ControlChange(lo, data_[0], data_[1]);
+      Device::ControlChange(lo, data[0], data[1]);
       break;
 
     case 0xc0:
-      Device::ProgramChange(lo, data_[0]);
+      Device::ProgramChange(lo, data[0]);
       break;
 
     case 0xd0:
-      Device::Aftertouch(lo, data_[0]);
+      Device::Aftertouch(lo, data[0]);
       break;
 
     case 0xe0:
-      Device::PitchBend(lo, (static_cast<uint16_t>(data_[1]) << 7) + data_[0]);
+      Device::PitchBend(lo, (static_cast<uint16_t>(data[1]) << 7) + data[0]);
       break;
 
     case 0xf0:
       switch(lo) {
         case 0x0:
-          Device::SysExByte(data_[0]);
+          Device::SysExByte(data[0]);
           break;
         case 0x1:
+          Device::QuarterFrame(data[0]);
+          break;
         case 0x2:
+          Device::SongPosition((static_cast<uint16_t>(data[1]) << 7) + data[0]);
+          break;
         case 0x3:
         case 0x4:
         case 0x5:
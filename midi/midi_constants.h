@@ -29,6 +29,16 @@ static constexpr uint8_t channelMessage(uint8_t type, uint8_t channel) {
   return byteOr(type, channelMask(channel));
 }
 
+static constexpr uint8_t channelMessageType(uint8_t status) {
+  return byteAnd(status, 0xf0);
+}
+
+// Number of data bytes following the status byte of a channel message.
+static constexpr uint8_t channelMessageDataSize(uint8_t status) {
+  return channelMessageType(status) == MIDI_PROGRAM_CHANGE ||
+      channelMessageType(status) == MIDI_CHAN_AFTERTOUCH ? 1 : 2;
+}
+
 static constexpr uint8_t noteOffFor(uint8_t channel) {
   return byteOr(MIDI_NOTE_OFF, channelMask(channel));
 }
@@ -20,43 +20,23 @@
 #include "midipal/app.h"
 
 #include <avr/eeprom.h>
+#include <avr/interrupt.h>
 #include <midi/midi_constants.h>
 
 #include "avrlib/serial.h"
 
+#include "midipal/app_registry.h"
 #include "midipal/display.h"
+#include "midipal/engine.h"
 #include "midipal/hardware_config.h"
 #include "midipal/event_scheduler.h"
 #include "midipal/midi_handler.h"
+#include "midipal/note_stack.h"
+#include "midipal/pipeline.h"
+#include "midipal/settings_store.h"
 #include "midipal/ui.h"
 
-#include "midipal/apps/app_selector.h"
-#include "midipal/apps/arpeggiator.h"
-#include "midipal/apps/bpm_meter.h"
-#include "midipal/apps/cc_knob.h"
-#include "midipal/apps/chord_memory.h"
-#include "midipal/apps/clock_divider.h"
-#include "midipal/apps/clock_source.h"
-#include "midipal/apps/clock_source_hd.h"
-#include "midipal/apps/clock_source_live.h"
-#include "midipal/apps/combiner.h"
-#include "midipal/apps/controller.h"
-#include "midipal/apps/delay.h"
-#include "midipal/apps/dispatcher.h"
-#include "midipal/apps/drum_pattern_generator.h"
-#include "midipal/apps/filter.h"
-#include "midipal/apps/generic_filter.h"
-#include "midipal/apps/lfo.h"
-#include "midipal/apps/monitor.h"
-#include "midipal/apps/poly_sequencer.h"
-#include "midipal/apps/randomizer.h"
-#include "midipal/apps/scale_processor.h"
-#include "midipal/apps/sequencer.h"
-#include "midipal/apps/sh_sequencer.h"
-#include "midipal/apps/sync_latch.h"
 #include "midipal/apps/settings.h"
-#include "midipal/apps/splitter.h"
-#include "midipal/apps/tanpura.h"
 
 namespace midipal {
 
@@ -69,53 +49,47 @@ using namespace avrlib;
 
 using MidiOut = Serial<MidiPort, 31250, DISABLED, POLLED>;
 
+#ifndef APP_PIPELINE
+/* extern */
+uint8_t app_arena[AppRegistry::arena_size];
+
+// The note tables are set up at boot, whether the running app uses them or
+// not.
+static_assert(
+    AppRegistry::arena_size >= kNoteStackArenaEnd,
+    "The arena cannot hold the note tables");
+#endif  // APP_PIPELINE
+
 /* static */
 AppInfo App::app_info_;
 
-static const AppInfo* registry[] = {
-#ifdef POLY_SEQUENCER_FIRMWARE
-  &apps::AppSelector::app_info_,
-  &apps::Monitor::app_info_,
-  &apps::PolySequencer::app_info_,
-  &apps::ClockSource::app_info_,
-  &apps::SyncLatch::app_info_,
-#else  // no POLY_SEQUENCER_FIRMWARE
-  &apps::AppSelector::app_info_,
-  &apps::Monitor::app_info_,
-  &apps::BpmMeter::app_info_,
-  &apps::Filter::app_info_,
-  &apps::Splitter::app_info_,
-  &apps::Dispatcher::app_info_,
-  &apps::Combiner::app_info_,
-  &apps::ClockDivider::app_info_,
-  &apps::SyncLatch::app_info_,
-#ifdef USE_HD_CLOCK
-  &apps::ClockSourceHD::app_info_,
-#else
-  &apps::ClockSource::app_info_,
-#endif  // USE_HD_CLOCK
-  &apps::CcKnob::app_info_,
-  &apps::DrumPatternGenerator::app_info_,
-  &apps::Randomizer::app_info_,
-  &apps::ChordMemory::app_info_,
-  &apps::Arpeggiator::app_info_,
-  &apps::Delay::app_info_,
-  &apps::ScaleProcessor::app_info_,
-#ifdef USE_SH_SEQUENCER
-  &apps::ShSequencer::app_info_,
-#else
-  &apps::Sequencer::app_info_,
-#endif
-  &apps::Lfo::app_info_,
-  &apps::Tanpura::app_info_,
-  &apps::GenericFilter::app_info_,
-  &apps::Settings::app_info_
-#endif  // POLY_SEQUENCER_FIRMWARE
-};
+/* static */
+uint8_t App::app_index_;
+
+#ifdef APP_PIPELINE
+/* static */
+uint8_t App::midi_app_index_;
+#endif  // APP_PIPELINE
+
+/* static */
+uint8_t App::output_high_water_;
+
+/* static */
+uint16_t App::output_stalls_;
+
+/* static */
+uint16_t App::output_drops_;
+
+/* static */
+PendingMessage App::pending_messages_[kNumPendingMessages];
+
+/* static */
+uint8_t App::num_pending_messages_;
+
 
 /* static */
 uint8_t App::num_apps() {
-  return sizeof(registry)/sizeof(AppInfo*);
+  return AppRegistry::size;
 }
 
 /* static */
@@ -128,19 +102,18 @@ void App::Init() {
 
 /* static */
 void App::SaveSettings() {
-  eeprom_write_block(settings_data(), reinterpret_cast<void*>(settings_offset()), settings_size());
+  SettingsStore::MarkAllDirty();
 }
 
 /* static */
 void App::LoadSettings() {
   eeprom_read_block(settings_data(), reinterpret_cast<void*>(settings_offset()), settings_size());
+  SettingsStore::ApplyFlagLog();
 }
 
 /* static */
 void App::SaveSetting(uint16_t key) {
-  auto parameter_address = reinterpret_cast<uint8_t*>(settings_offset()) + key;
-  // can't use getParameter as it only takes uint8_t offset
-  eeprom_write_byte(parameter_address, *(settings_data() + key));
+  SettingsStore::MarkDirty(key);
 }
 
 /* static */
@@ -149,53 +122,296 @@ void App::ResetToFactorySettings() {
   SaveSettings();
 }
 
+/* static */
+uint8_t App::app_name(uint8_t app_index) {
+  return pgm_read_byte(&AppRegistry::info[app_index]->app_name);
+}
+
 /* static */
 void App::Launch(uint8_t app_index) {
-  memcpy_P(&app_info_, registry[app_index], sizeof(AppInfo));
+  // The settings waiting to be written belong to the app being replaced.
+  SettingsStore::Flush();
+  memcpy_P(&app_info_, AppRegistry::info[app_index], sizeof(AppInfo));
+  app_index_ = app_index;
 }
 
 /* static */
 void App::SendNow(uint8_t byte) {
+#ifdef APP_PIPELINE
+  if (!Pipeline::last_stage()) {
+    Pipeline::ForwardByte(byte);
+    return;
+  }
+#endif  // APP_PIPELINE
+  if (byte >= 0xf8) {
+    // Realtime bytes do not wait for the UART: they go through their own
+    // lane, serviced by TransmitOutputByte() before the output buffer.
+    while (!RealtimeOutput::Buffer::writable()) {
+      TransmitOutputByte();
+    }
+    uint8_t sreg = SREG;
+    cli();
+    if (!RealtimeOutput::Buffer::readable() && MidiOut::writable()) {
+      LedOut::High();
+      MidiOut::Overwrite(byte);
+    } else {
+      RealtimeOutput::Buffer::Overwrite(byte);
+    }
+    SREG = sreg;
+    return;
+  }
+  if (byte == 0xf0) {
+    Engine::BeginSysExOutput();
+  } else if (byte >= 0x80) {
+    // 0xf7, or any other status byte, ends the SysEx message.
+    Engine::EndSysExOutput();
+  } else {
+    Engine::InvalidateRunningStatus();
+  }
   LedOut::High();
-  MidiOut::Write(byte);
+  while (true) {
+    uint8_t sreg = SREG;
+    cli();
+    bool sent = false;
+    if (MidiOut::writable()) {
+      // A clock tick posted by the timer interrupt while we were waiting
+      // goes first.
+      if (RealtimeOutput::Buffer::readable()) {
+        MidiOut::Overwrite(RealtimeOutput::Buffer::ImmediateRead());
+      } else {
+        MidiOut::Overwrite(byte);
+        sent = true;
+      }
+    }
+    SREG = sreg;
+    if (sent) {
+      break;
+    }
+  }
 }
 
 /* static */
 void App::Send3(uint8_t a, uint8_t b, uint8_t c) {
-  FlushOutputBuffer(3);
-  MidiHandler::OutputBuffer::Write(a);
-  MidiHandler::OutputBuffer::Write(b);
-  MidiHandler::OutputBuffer::Write(c);
+#ifdef APP_PIPELINE
+  if (!Pipeline::last_stage()) {
+    uint8_t data[2] = { b, c };
+    Pipeline::Forward(a, data, 2);
+    return;
+  }
+#endif  // APP_PIPELINE
+  uint8_t sreg = SREG;
+  cli();
+  if (ReserveOutput(a, b, c, 3, sreg)) {
+    MidiHandler::OutputBuffer::Write(a);
+    MidiHandler::OutputBuffer::Write(b);
+    MidiHandler::OutputBuffer::Write(c);
+  }
+  SREG = sreg;
 }
 
 /* static */
 void App::Send(uint8_t status, uint8_t* data, uint8_t size) {
-  FlushOutputBuffer(size + 1);
-  MidiHandler::OutputBuffer::Write(status);
-  if (size) {
-    MidiHandler::OutputBuffer::Write(*data++);
-    --size;
+#ifdef APP_PIPELINE
+  if (!Pipeline::last_stage()) {
+    Pipeline::Forward(status, data, size);
+    return;
   }
-  if (size) {
-    MidiHandler::OutputBuffer::Write(*data++);
-    --size;
+#endif  // APP_PIPELINE
+  uint8_t data_1 = size ? data[0] : 0;
+  uint8_t data_2 = size > 1 ? data[1] : 0;
+  uint8_t sreg = SREG;
+  cli();
+  if (ReserveOutput(status, data_1, data_2, size + 1, sreg)) {
+    MidiHandler::OutputBuffer::Write(status);
+    if (size) {
+      MidiHandler::OutputBuffer::Write(data_1);
+    }
+    if (size > 1) {
+      MidiHandler::OutputBuffer::Write(data_2);
+    }
   }
+  SREG = sreg;
 }
 
 /* static */
-void App::FlushOutputBuffer(uint8_t requested_size) {
-  while (MidiHandler::OutputBuffer::writable() < requested_size) {
+bool App::ReserveOutput(
+    uint8_t status, uint8_t data_1, uint8_t data_2, uint8_t size,
+    uint8_t sreg) {
+  uint8_t type = channelMessageType(status);
+  uint8_t reserve = 0;
+  if (type == MIDI_NOTE_ON && data_2) {
+    reserve = kOutputReserveNoteOn;
+  } else if (type != MIDI_NOTE_OFF && type != MIDI_NOTE_ON && status < 0xf0) {
+    reserve = kOutputReserveControl;
+    // A newer value for a controller still waiting in the pending list
+    // replaces it there, so that it cannot be overtaken by the older one.
+    PendingMessage* pending = FindPendingMessage(status, data_1);
+    if (pending && pending->status) {
+      CountOutputDrop();
+      pending->data_1 = data_1;
+      pending->data_2 = data_2;
+      return false;
+    }
+  }
+  // The messages left waiting are older, so they go first.
+  if (num_pending_messages_ && !Engine::sysex_output()) {
+    WritePendingMessages();
+  }
+  if (MidiHandler::OutputBuffer::writable() < size + reserve) {
     Display::set_status('!');
-    // XXX apparently a bug?
-    //midi_out.Write(MidiHandler::OutputBuffer::Read());
+    if (reserve == kOutputReserveNoteOn) {
+      CountOutputDrop();
+      return false;
+    }
+    // Note offs and system messages are never dropped. While a SysEx message
+    // is written to the UART, the buffer is held back, maybe by the code
+    // this interrupt has stopped: they wait in the pending list until the
+    // SysEx message is over. Only if the list is full are they lost.
+    if (reserve || Engine::sysex_output()) {
+      PendingMessage* pending = FindPendingMessage(status, data_1);
+      if (pending) {
+        if (!pending->status) {
+          ++num_pending_messages_;
+        }
+        pending->status = status;
+        pending->data_1 = data_1;
+        pending->data_2 = data_2;
+      } else {
+        CountOutputDrop();
+      }
+      return false;
+    }
+    // Otherwise, the buffer is drained from here rather than by waiting for
+    // the timer interrupt, which might be the one we are running from.
+    if (output_stalls_ != 0xffff) {
+      ++output_stalls_;
+    }
+    while (MidiHandler::OutputBuffer::writable() < size) {
+      SREG = sreg;
+      TransmitOutputByte();
+      cli();
+    }
+  }
+  uint8_t level = MidiHandler::OutputBuffer::readable() + size;
+  if (level > output_high_water_) {
+    output_high_water_ = level;
+  }
+  return true;
+}
+
+/* static */
+PendingMessage* App::FindPendingMessage(uint8_t status, uint8_t data_1) {
+  // Controllers, poly aftertouch and note offs are told apart by their first
+  // data byte.
+  uint8_t type = channelMessageType(status);
+  bool keyed = type == MIDI_CONTROL_CHANGE || type == MIDI_POLY_AFTERTOUCH ||
+      type == MIDI_NOTE_OFF || type == MIDI_NOTE_ON;
+  PendingMessage* free_slot = NULL;
+  for (uint8_t i = 0; i < kNumPendingMessages; ++i) {
+    PendingMessage* m = &pending_messages_[i];
+    if (!m->status) {
+      free_slot = m;
+    } else if (m->status == status && (!keyed || m->data_1 == data_1)) {
+      return m;
+    }
+  }
+  return free_slot;
+}
+
+/* static */
+void App::FlushPendingMessage() {
+  if (!num_pending_messages_) {
+    return;
+  }
+  // Send() may be writing a message, or updating the pending list, in the
+  // code this interrupt has stopped.
+  uint8_t sreg = SREG;
+  cli();
+  if (!Engine::sysex_output()) {
+    WritePendingMessages();
+  }
+  SREG = sreg;
+}
+
+/* static */
+void App::WritePendingMessages() {
+  for (uint8_t i = 0; i < kNumPendingMessages; ++i) {
+    PendingMessage* m = &pending_messages_[i];
+    if (!m->status) {
+      continue;
+    }
+    uint8_t data_size = pgm_read_byte(m->status >= 0xf0
+        ? midi::kSystemMessageDataSize + byteAnd(m->status, 0x0f)
+        : midi::kChannelMessageDataSize + (m->status >> 4));
+    // Controller-like messages leave the same room as when they are sent.
+    uint8_t room = data_size + 1;
+    if (m->status < 0xf0 && channelMessageType(m->status) != MIDI_NOTE_OFF &&
+        channelMessageType(m->status) != MIDI_NOTE_ON) {
+      room += kOutputReserveControl;
+    }
+    if (MidiHandler::OutputBuffer::writable() < room) {
+      continue;
+    }
+    MidiHandler::OutputBuffer::Write(m->status);
+    if (data_size) {
+      MidiHandler::OutputBuffer::Write(m->data_1);
+    }
+    if (data_size > 1) {
+      MidiHandler::OutputBuffer::Write(m->data_2);
+    }
+    m->status = 0;
+    --num_pending_messages_;
   }
 }
 
+/* static */
+bool App::TransmitOutputByte() {
+  bool sent = false;
+  // Popping the byte and writing it to the UART must not be split by another
+  // interrupt doing the same, or bytes would be sent out of order.
+  uint8_t sreg = SREG;
+  cli();
+  uint8_t byte;
+  if (MidiOut::writable()) {
+    if (RealtimeOutput::Buffer::readable()) {
+      byte = RealtimeOutput::Buffer::ImmediateRead();
+      sent = true;
+    } else {
+      sent = Engine::PopOutputByte(&byte);
+    }
+    if (sent) {
+      LedOut::High();
+      MidiOut::Overwrite(byte);
+    }
+  }
+  SREG = sreg;
+  return sent;
+}
+
 /* static */
 void App::SendLater(uint8_t note, uint8_t velocity, uint8_t when, uint8_t tag) {
   EventScheduler::Schedule(note, velocity, when, tag);
 }
 
+/* static */
+void App::SendMessageLater(
+    uint8_t status, uint8_t data_1, uint8_t data_2, uint8_t when) {
+  EventScheduler::ScheduleMessage(status, data_1, data_2, when);
+}
+
+/* static */
+void App::SendScheduledEvent(
+    const EventScheduler::Entry& entry, uint8_t channel) {
+  if (entry.status) {
+    uint8_t data[2] = { entry.note, entry.velocity };
+    Send(entry.status, data, channelMessageDataSize(entry.status));
+  } else if (entry.velocity == 0) {
+    Send3(noteOffFor(channel), entry.note, 0);
+  } else {
+    Send3(noteOnFor(channel), entry.note, entry.velocity);
+  }
+}
+
 /* static */
 void App::SendScheduledNotes(uint8_t channel) {
   uint8_t current = EventScheduler::root();
@@ -204,13 +420,7 @@ void App::SendScheduledNotes(uint8_t channel) {
     if (entry.when) {
       break;
     }
-    if (entry.note != EventScheduler::kZombieSlot) {
-      if (entry.velocity == 0) {
-        Send3(noteOffFor(channel), entry.note, 0);
-      } else {
-        Send3(noteOnFor(channel), entry.note, entry.velocity);
-      }
-    }
+    SendScheduledEvent(entry, channel);
     current = entry.next;
   }
   EventScheduler::Tick();
@@ -223,6 +433,21 @@ void App::FlushQueue(uint8_t channel) {
   }
 }
 
+/* static */
+void App::LocateSongPosition(
+    uint16_t position,
+    uint8_t prescaler,
+    uint8_t num_steps,
+    uint8_t* tick,
+    uint8_t* step) {
+  // A song position is counted in sixteenth notes, 6 clock ticks each. The
+  // steps already played are those starting on one of the elapsed ticks.
+  uint32_t elapsed = static_cast<uint32_t>(position) * 6 + prescaler - 1;
+  uint32_t steps = elapsed / prescaler;
+  *tick = elapsed - steps * prescaler;
+  *step = num_steps ? steps % num_steps : 0;
+}
+
 
 /* static */
 void App::RemoteControl(uint8_t channel, uint8_t cc_num, uint8_t value) {
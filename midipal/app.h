@@ -18,11 +18,23 @@
 
 #include "avrlib/base.h"
 
+#include "midipal/event_scheduler.h"
 #include "midipal/resources.h"
 #include "ui.h"
 
 namespace midipal {
 
+// Firmware presets chaining several apps: the messages sent by each stage are
+// handed to the handlers of the next one, and only the last stage writes to
+// the output buffer. See pipeline.h.
+#if defined(PIPELINE_FILTER_SCALE_ARPEGGIATOR) || defined(PIPELINE_SPLITTER_DELAY)
+#define APP_PIPELINE
+// The stages are known at compile time, so are their handlers.
+#ifndef STATIC_APP_DISPATCH
+#define STATIC_APP_DISPATCH
+#endif  // STATIC_APP_DISPATCH
+#endif
+
 enum EepromSetting : uint16_t {
   // Settings must be defined here. Please leave some space between them
   // to allow for future improvements of apps.
@@ -51,7 +63,13 @@ enum EepromSetting : uint16_t {
   SETTINGS_GENERIC_FILTER_SETTINGS = 640,
   SETTINGS_GENERIC_FILTER_SETTINGS_DUMP_AREA = 896,
   SETTINGS_APP_SELECTOR = 1008,
-  SETTINGS_SYSTEM_SETTINGS = 1012
+  SETTINGS_SYSTEM_SETTINGS = 1012,
+  // Journal of the running/recording flags, see settings_store.h.
+#ifdef POLY_SEQUENCER_FIRMWARE
+  SETTINGS_FLAG_LOG = 832
+#else
+  SETTINGS_FLAG_LOG = 432
+#endif  // POLY_SEQUENCER_FIRMWARE
 };
 
 enum ClockMode {
@@ -60,6 +78,70 @@ enum ClockMode {
   CLOCK_MODE_NOTE,
 };
 
+// Room which must remain in the output buffer after queuing a note on, or a
+// controller, pitch bend, aftertouch or program change message. Note offs and
+// system messages can use the whole buffer, so that they are never dropped.
+static const uint8_t kOutputReserveNoteOn = 16;
+static const uint8_t kOutputReserveControl = 32;
+// Controller-like messages which cannot be queued are kept here, the latest
+// value overwriting the previous one, until the buffer drains. So are note
+// offs and system messages while a SysEx message holds the buffer back.
+static const uint8_t kNumPendingMessages = 4;
+
+struct PendingMessage {
+  uint8_t status;
+  uint8_t data_1;
+  uint8_t data_2;
+};
+
+// Apps only use their settings while they are running, so they all keep them
+// in the same block of RAM, sized by AppRegistry for the largest one. The app
+// selector and the system settings, which are used by the other apps, have
+// their own storage. In a pipeline firmware, the stages run together and
+// each keeps its own.
+//
+// The same goes for the note map, the note stack and the voice allocator,
+// which only a few apps use: they are kept in the arena past the settings of
+// these apps, which declare them with APP_SETTINGS_AND_TABLES. The settings of
+// the other apps overwrite them.
+extern uint8_t app_arena[];
+
+#ifdef APP_PIPELINE
+#define APP_SETTINGS(size) \
+  static const uint16_t arena_size = 0; \
+  static uint8_t settings[size]
+#define APP_SETTINGS_AND_TABLES(size, tables_offset, tables_end) \
+  APP_SETTINGS(size)
+#define DEFINE_APP_SETTINGS(Class) \
+  uint8_t Class::settings[Class::Parameter::COUNT]
+#else
+#define APP_SETTINGS(size) \
+  static const uint16_t arena_size = size; \
+  static constexpr uint8_t* settings = app_arena
+#define APP_SETTINGS_AND_TABLES(size, tables_offset, tables_end) \
+  static_assert(size <= tables_offset, "Settings overlapping the tables"); \
+  static const uint16_t arena_size = tables_end; \
+  static constexpr uint8_t* settings = app_arena
+#define DEFINE_APP_SETTINGS(Class) \
+  constexpr uint8_t* Class::settings
+#endif  // APP_PIPELINE
+
+// A table kept at offset in the arena, or on its own in a pipeline firmware.
+template<typename T, uint16_t offset>
+struct ArenaObject {
+#ifdef APP_PIPELINE
+  static T& get() { return object_; }
+  static T object_;
+#else
+  static T& get() { return *reinterpret_cast<T*>(app_arena + offset); }
+#endif  // APP_PIPELINE
+};
+
+#ifdef APP_PIPELINE
+template<typename T, uint16_t offset>
+T ArenaObject<T, offset>::object_;
+#endif  // APP_PIPELINE
+
 struct AppInfo {
   void (*OnInit)();
   void (*OnNoteOn)(uint8_t, uint8_t, uint8_t);
@@ -74,6 +156,8 @@ struct AppInfo {
   void (*OnStart)();
   void (*OnContinue)();
   void (*OnStop)();
+  void (*OnSongPosition)(uint16_t);
+  void (*OnQuarterFrame)(uint8_t);
   bool (*CheckChannel)(uint8_t);
   void (*OnRawByte)(uint8_t);
   void (*OnRawMidiData)(uint8_t, uint8_t *, uint8_t);
@@ -106,7 +190,8 @@ class App {
  public:
   static void Init();
 
-  // Can be used to save/load settings in EEPROM.
+  // Can be used to save/load settings in EEPROM. Saved settings are written
+  // by SettingsStore, from the main loop.
   static void SaveSetting(uint16_t key);
   static void SaveSettings();
   static void LoadSettings();
@@ -118,6 +203,30 @@ class App {
       app_info_.OnInit();
     }
   }
+#ifdef STATIC_APP_DISPATCH
+  // Defined in app_registry.h.
+  static inline void OnNoteOn(uint8_t channel, uint8_t note, uint8_t velocity);
+  static inline void OnNoteOff(uint8_t channel, uint8_t note, uint8_t velocity);
+  static inline void OnAftertouch(
+      uint8_t channel, uint8_t note, uint8_t velocity);
+  static inline void OnAftertouch(uint8_t channel, uint8_t velocity);
+  static inline void OnControlChange(
+      uint8_t channel, uint8_t cc_num, uint8_t value);
+  static inline void OnProgramChange(uint8_t channel, uint8_t program);
+  static inline void OnPitchBend(uint8_t channel, uint16_t pitch_bend);
+  static inline void OnSysExByte(uint8_t sysex_byte);
+  static inline void OnClock(uint8_t clock_mode);
+  static inline void OnStart();
+  static inline void OnContinue();
+  static inline void OnStop();
+  static inline void OnSongPosition(uint16_t position);
+  static inline void OnQuarterFrame(uint8_t data);
+  static inline bool CheckChannel(uint8_t channel);
+  static inline void OnRawByte(uint8_t byte);
+  static inline bool has_raw_byte_handler();
+  static inline void OnRawMidiData(
+      uint8_t status, uint8_t* data, uint8_t data_size);
+#else
   static void OnNoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
     if (app_info_.OnNoteOn) {
       app_info_.OnNoteOn(channel, note, velocity);
@@ -157,7 +266,7 @@ class App {
   static void OnSysExByte(uint8_t sysex_byte) {
     if (app_info_.OnSysExByte) {
       app_info_.OnSysExByte(sysex_byte);
-    } else if (!app_info_.OnRawByte) {
+    } else if (!has_raw_byte_handler()) {
       // Forwarding will not be handled by OnRawByte, nor by OnRawMidiData,
       // so we do it explicitly here.
       SendNow(sysex_byte);
@@ -184,6 +293,16 @@ class App {
       app_info_.OnStop();
     }
   }
+  static void OnSongPosition(uint16_t position) {
+    if (app_info_.OnSongPosition) {
+      app_info_.OnSongPosition(position);
+    }
+  }
+  static void OnQuarterFrame(uint8_t data) {
+    if (app_info_.OnQuarterFrame) {
+      app_info_.OnQuarterFrame(data);
+    }
+  }
 
   static bool CheckChannel(uint8_t channel) {
     if (app_info_.CheckChannel) {
@@ -198,11 +317,15 @@ class App {
       app_info_.OnRawByte(byte);
     }
   }
+  static bool has_raw_byte_handler() {
+    return app_info_.OnRawByte != nullptr;
+  }
   static void OnRawMidiData(uint8_t status, uint8_t* data, uint8_t data_size) {
     if (app_info_.OnRawMidiData) {
       app_info_.OnRawMidiData(status, data, data_size);
     }
   }
+#endif  // STATIC_APP_DISPATCH
 
   // Event handlers for UI.
   static uint8_t OnIncrement(int8_t increment) {
@@ -277,11 +400,48 @@ class App {
   // in PROGMEM
   static inline const uint8_t* factory_data() { return app_info_.factory_data; }
   static inline uint8_t app_name() { return app_info_.app_name; }
+  // Launching an app to read its name would hand it the MIDI input, with the
+  // arena holding the settings of another app.
+  static uint8_t app_name(uint8_t app_index);
+  static inline uint8_t app_index() { return app_index_; }
+  // Also with the main loop events: TIMER1 then interrupts the main loop
+  // instead of TIMER2, and the writes to the output buffer are atomic either
+  // way.
   static inline bool realtime_clock_handling() {
     return app_info_.realtime_clock_handling;
   }
+  // Index in the registry of the app to which the MIDI event handlers are
+  // dispatched: the launched app, or in a pipeline firmware, the stage the
+  // event is addressed to.
+  static inline uint8_t midi_app_index() {
+#ifdef APP_PIPELINE
+    return midi_app_index_;
+#else
+    return app_index_;
+#endif  // APP_PIPELINE
+  }
+#ifdef APP_PIPELINE
+  static void set_midi_app_index(uint8_t index) { midi_app_index_ = index; }
+#endif  // APP_PIPELINE
 
-  static void FlushOutputBuffer(uint8_t size);
+  // Moves one byte to the UART, if it is ready. Pending realtime bytes are
+  // sent first, then the output buffer.
+  static bool TransmitOutputByte();
+  // Queues one of the pending controller messages, if the buffer has room.
+  static void FlushPendingMessage();
+  // Highest number of bytes queued in the output buffer, number of times
+  // a handler had to wait for room in it, and number of messages dropped or
+  // overwritten by a newer value, since the last reset.
+  static uint8_t output_high_water() { return output_high_water_; }
+  static uint16_t output_stalls() { return output_stalls_; }
+  static uint16_t output_drops() { return output_drops_; }
+  static void ResetOutputStatistics() {
+    output_high_water_ = 0;
+    output_stalls_ = 0;
+    output_drops_ = 0;
+  }
+  // Sends a byte without going through the output buffer. Realtime bytes
+  // never block, other bytes wait for the UART.
   static void SendNow(uint8_t byte);
   static void Send(uint8_t status, uint8_t* data, uint8_t size);
   static void Send3(uint8_t a, uint8_t b, uint8_t c);
@@ -289,17 +449,65 @@ class App {
     SendLater(note, velocity, when, 0);
   }
   static void SendLater(uint8_t note, uint8_t velocity, uint8_t when, uint8_t tag);
+  static void SendMessageLater(
+      uint8_t status, uint8_t data_1, uint8_t data_2, uint8_t when);
+  // Sends all the events due at the current tick, notes being sent on the
+  // given channel, and advances the scheduler.
   static void SendScheduledNotes(uint8_t channel);
+  static void SendScheduledEvent(
+      const EventScheduler::Entry& entry, uint8_t channel);
   static void FlushQueue(uint8_t channel);
+  // Converts a song position into the state of a sequencer playing a step
+  // every prescaler clock ticks, and started with its tick counter set to
+  // prescaler - 1: tick counter, and index of the next step to play.
+  static void LocateSongPosition(
+      uint16_t position,
+      uint8_t prescaler,
+      uint8_t num_steps,
+      uint8_t* tick,
+      uint8_t* step);
 
   static uint8_t num_apps();
 
   static bool NoteClock(bool on, uint8_t channel, uint8_t note);
 
  private:
+
   static void RemoteControl(uint8_t channel, uint8_t cc_num, uint8_t value);
+  // Returns true if the message can be written to the output buffer. Note
+  // offs and system messages wait for room - or, while a SysEx message is
+  // being sent, are moved to the pending list. When the buffer is too full,
+  // note ons are dropped, and controller-like messages are moved to the
+  // pending list - or dropped if it is full.
+  // To be called with interrupts disabled, and to write the message before
+  // enabling them again: the timer interrupt also writes to the output buffer
+  // and to the pending list. They are restored to sreg while waiting for
+  // the UART.
+  static bool ReserveOutput(
+      uint8_t status, uint8_t data_1, uint8_t data_2, uint8_t size,
+      uint8_t sreg);
+  // Returns the pending message with the same status (and controller number),
+  // or a free slot, or NULL.
+  static PendingMessage* FindPendingMessage(uint8_t status, uint8_t data_1);
+  // Moves the pending messages for which there is room to the output buffer.
+  // To be called with interrupts disabled.
+  static void WritePendingMessages();
+  static void CountOutputDrop() {
+    if (output_drops_ != 0xffff) {
+      ++output_drops_;
+    }
+  }
 
   static AppInfo app_info_;
+  static uint8_t app_index_;
+#ifdef APP_PIPELINE
+  static uint8_t midi_app_index_;
+#endif  // APP_PIPELINE
+  static uint8_t output_high_water_;
+  static uint16_t output_stalls_;
+  static uint16_t output_drops_;
+  static PendingMessage pending_messages_[kNumPendingMessages];
+  static uint8_t num_pending_messages_;
 
   DISALLOW_COPY_AND_ASSIGN(App);
 };
@@ -0,0 +1,393 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// List of the apps built into the firmware, in the order of the app selector.
+//
+// With -DSTATIC_APP_DISPATCH, the MIDI event handlers of App are defined here:
+// instead of an indirect call through the RAM copy of the AppInfo, each event
+// goes through a comparison chain on the index of the launched app (or of the
+// pipeline stage), ending with a direct call to the app's static method. An
+// app is assumed to handle an event if it has a static method named after the
+// AppInfo field, which is how all the apps register their handlers. Pipeline
+// firmwares always dispatch this way.
+
+#ifndef MIDIPAL_APP_REGISTRY_H_
+#define MIDIPAL_APP_REGISTRY_H_
+
+#include "midipal/app.h"
+
+#include "midipal/apps/app_selector.h"
+#include "midipal/apps/arpeggiator.h"
+#include "midipal/apps/bpm_meter.h"
+#include "midipal/apps/cc_knob.h"
+#include "midipal/apps/chord_memory.h"
+#include "midipal/apps/clock_divider.h"
+#include "midipal/apps/clock_source.h"
+#include "midipal/apps/clock_source_hd.h"
+#include "midipal/apps/clock_source_live.h"
+#include "midipal/apps/combiner.h"
+#include "midipal/apps/controller.h"
+#include "midipal/apps/delay.h"
+#include "midipal/apps/dispatcher.h"
+#include "midipal/apps/drum_pattern_generator.h"
+#include "midipal/apps/filter.h"
+#include "midipal/apps/generic_filter.h"
+#include "midipal/apps/lfo.h"
+#include "midipal/apps/monitor.h"
+#include "midipal/apps/poly_sequencer.h"
+#include "midipal/apps/randomizer.h"
+#include "midipal/apps/scale_processor.h"
+#include "midipal/apps/sequencer.h"
+#include "midipal/apps/sh_sequencer.h"
+#include "midipal/apps/sync_latch.h"
+#include "midipal/apps/settings.h"
+#include "midipal/apps/splitter.h"
+#include "midipal/apps/tanpura.h"
+
+namespace midipal {
+
+template<uint8_t n, typename... Apps>
+struct StaticDispatcher {
+  template<typename Caller, typename... Args>
+  static inline bool Call(uint8_t index, Args... args) { return false; }
+};
+
+template<uint8_t n, typename First, typename... Rest>
+struct StaticDispatcher<n, First, Rest...> {
+  // Returns what the caller returns for the app at index.
+  template<typename Caller, typename... Args>
+  static inline bool Call(uint8_t index, Args... args) {
+    if (index == n) {
+      return Caller::template Call<First>(0, args...);
+    }
+    return StaticDispatcher<n + 1, Rest...>::template Call<Caller>(
+        index, args...);
+  }
+};
+
+// Number of bytes of the app arena used by an app - 0 if it has its own
+// storage.
+template<typename App>
+constexpr auto ArenaSize(int) -> decltype(App::arena_size) {
+  return App::arena_size;
+}
+template<typename App>
+constexpr uint16_t ArenaSize(long) { return 0; }
+
+template<typename... Apps>
+struct MaxArenaSize {
+  static const uint16_t value = 0;
+};
+
+template<typename First, typename... Rest>
+struct MaxArenaSize<First, Rest...> {
+  static const uint16_t value =
+      ArenaSize<First>(0) > MaxArenaSize<Rest...>::value
+          ? ArenaSize<First>(0)
+          : MaxArenaSize<Rest...>::value;
+};
+
+// Number of settings of an app.
+template<typename App>
+constexpr auto SettingsSize(int)
+    -> decltype(App::Parameter::COUNT, uint16_t()) {
+  return App::Parameter::COUNT;
+}
+template<typename App>
+constexpr uint16_t SettingsSize(long) { return 0; }
+
+template<typename... Apps>
+struct MaxSettingsSize {
+  static const uint16_t value = 0;
+};
+
+template<typename First, typename... Rest>
+struct MaxSettingsSize<First, Rest...> {
+  static const uint16_t value =
+      SettingsSize<First>(0) > MaxSettingsSize<Rest...>::value
+          ? SettingsSize<First>(0)
+          : MaxSettingsSize<Rest...>::value;
+};
+
+// Settings keys of the flags going to the EEPROM journal rather than to their
+// own location - kNoKey if the app has no such setting.
+static const uint8_t kNoKey = 0xff;
+
+template<typename App>
+constexpr auto RunningKey(int)
+    -> decltype(App::Parameter::running_, uint8_t()) {
+  return App::Parameter::running_;
+}
+template<typename App>
+constexpr uint8_t RunningKey(long) { return kNoKey; }
+
+template<typename App>
+constexpr auto RecordingKey(int)
+    -> decltype(App::Parameter::recording_, uint8_t()) {
+  return App::Parameter::recording_;
+}
+template<typename App>
+constexpr uint8_t RecordingKey(long) { return kNoKey; }
+
+static const uint8_t kNumLoggedFlags = 2;
+
+template<typename... Apps>
+struct AppList {
+  static const uint8_t size = sizeof...(Apps);
+  static const uint16_t arena_size = MaxArenaSize<Apps...>::value;
+  static const uint16_t max_settings_size = MaxSettingsSize<Apps...>::value;
+  static const AppInfo* const info[sizeof...(Apps)];
+  static const uint8_t logged_flags[sizeof...(Apps)][kNumLoggedFlags] PROGMEM;
+
+  template<typename Caller, typename... Args>
+  static inline bool Dispatch(uint8_t index, Args... args) {
+    return StaticDispatcher<0, Apps...>::template Call<Caller>(index, args...);
+  }
+};
+
+template<typename... Apps>
+const AppInfo* const AppList<Apps...>::info[sizeof...(Apps)] = {
+  &Apps::app_info_...
+};
+
+template<typename... Apps>
+const uint8_t AppList<Apps...>::logged_flags[sizeof...(Apps)][kNumLoggedFlags]
+    PROGMEM = {
+  { RunningKey<Apps>(0), RecordingKey<Apps>(0) }...
+};
+
+#if defined(PIPELINE_FILTER_SCALE_ARPEGGIATOR)
+// The stages must follow the app selector, in the order of the pipeline.
+typedef AppList<
+    apps::AppSelector,
+    apps::Filter,
+    apps::ScaleProcessor,
+    apps::Arpeggiator,
+    apps::Settings> AppRegistry;
+#elif defined(PIPELINE_SPLITTER_DELAY)
+typedef AppList<
+    apps::AppSelector,
+    apps::Splitter,
+    apps::Delay,
+    apps::Settings> AppRegistry;
+#elif defined(POLY_SEQUENCER_FIRMWARE)
+typedef AppList<
+    apps::AppSelector,
+    apps::Monitor,
+    apps::PolySequencer,
+    apps::ClockSource,
+    apps::SyncLatch> AppRegistry;
+#else
+typedef AppList<
+    apps::AppSelector,
+    apps::Monitor,
+    apps::BpmMeter,
+    apps::Filter,
+    apps::Splitter,
+    apps::Dispatcher,
+    apps::Combiner,
+    apps::ClockDivider,
+    apps::SyncLatch,
+#ifdef USE_HD_CLOCK
+    apps::ClockSourceHD,
+#else
+    apps::ClockSource,
+#endif  // USE_HD_CLOCK
+    apps::CcKnob,
+    apps::DrumPatternGenerator,
+    apps::Randomizer,
+    apps::ChordMemory,
+    apps::Arpeggiator,
+    apps::Delay,
+    apps::ScaleProcessor,
+#ifdef USE_SH_SEQUENCER
+    apps::ShSequencer,
+#else
+    apps::Sequencer,
+#endif  // USE_SH_SEQUENCER
+    apps::Lfo,
+    apps::Tanpura,
+    apps::GenericFilter,
+    apps::Settings> AppRegistry;
+#endif
+
+#ifdef STATIC_APP_DISPATCH
+
+// Calls App::handler if it exists, and returns true. The int/long overloads
+// select the first one whenever the call expression is valid.
+#define DEFINE_HANDLER_CALLER(handler) \
+  struct handler##Caller { \
+    template<typename Target, typename... Args> \
+    static inline auto Call(int, Args... args) \
+        -> decltype(Target::handler(args...), true) { \
+      Target::handler(args...); \
+      return true; \
+    } \
+    template<typename Target, typename... Args> \
+    static inline bool Call(long, Args...) { return false; } \
+  };
+
+DEFINE_HANDLER_CALLER(OnNoteOn)
+DEFINE_HANDLER_CALLER(OnNoteOff)
+DEFINE_HANDLER_CALLER(OnNoteAftertouch)
+DEFINE_HANDLER_CALLER(OnAftertouch)
+DEFINE_HANDLER_CALLER(OnControlChange)
+DEFINE_HANDLER_CALLER(OnProgramChange)
+DEFINE_HANDLER_CALLER(OnPitchBend)
+DEFINE_HANDLER_CALLER(OnSysExByte)
+DEFINE_HANDLER_CALLER(OnClock)
+DEFINE_HANDLER_CALLER(OnStart)
+DEFINE_HANDLER_CALLER(OnContinue)
+DEFINE_HANDLER_CALLER(OnStop)
+DEFINE_HANDLER_CALLER(OnSongPosition)
+DEFINE_HANDLER_CALLER(OnQuarterFrame)
+DEFINE_HANDLER_CALLER(OnRawByte)
+DEFINE_HANDLER_CALLER(OnRawMidiData)
+
+#undef DEFINE_HANDLER_CALLER
+
+// Returns the app's answer, or true if it does not filter channels.
+struct CheckChannelCaller {
+  template<typename Target>
+  static inline auto Call(int, uint8_t channel)
+      -> decltype(Target::CheckChannel(channel)) {
+    return Target::CheckChannel(channel);
+  }
+  template<typename Target>
+  static inline bool Call(long, uint8_t channel) { return true; }
+};
+
+// Returns true if the app forwards raw bytes.
+struct OnRawByteRegistered {
+  template<typename Target>
+  static inline auto Call(int) -> decltype(&Target::OnRawByte, true) {
+    return true;
+  }
+  template<typename Target>
+  static inline bool Call(long) { return false; }
+};
+
+/* static */
+inline void App::OnNoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
+  AppRegistry::Dispatch<OnNoteOnCaller>(
+      midi_app_index(), channel, note, velocity);
+}
+
+/* static */
+inline void App::OnNoteOff(uint8_t channel, uint8_t note, uint8_t velocity) {
+  AppRegistry::Dispatch<OnNoteOffCaller>(
+      midi_app_index(), channel, note, velocity);
+}
+
+/* static */
+inline void App::OnAftertouch(
+    uint8_t channel, uint8_t note, uint8_t velocity) {
+  AppRegistry::Dispatch<OnNoteAftertouchCaller>(
+      midi_app_index(), channel, note, velocity);
+}
+
+/* static */
+inline void App::OnAftertouch(uint8_t channel, uint8_t velocity) {
+  AppRegistry::Dispatch<OnAftertouchCaller>(
+      midi_app_index(), channel, velocity);
+}
+
+/* static */
+inline void App::OnControlChange(
+    uint8_t channel, uint8_t cc_num, uint8_t value) {
+  RemoteControl(channel, cc_num, value);
+  AppRegistry::Dispatch<OnControlChangeCaller>(
+      midi_app_index(), channel, cc_num, value);
+}
+
+/* static */
+inline void App::OnProgramChange(uint8_t channel, uint8_t program) {
+  AppRegistry::Dispatch<OnProgramChangeCaller>(
+      midi_app_index(), channel, program);
+}
+
+/* static */
+inline void App::OnPitchBend(uint8_t channel, uint16_t pitch_bend) {
+  AppRegistry::Dispatch<OnPitchBendCaller>(
+      midi_app_index(), channel, pitch_bend);
+}
+
+/* static */
+inline void App::OnSysExByte(uint8_t sysex_byte) {
+  if (!AppRegistry::Dispatch<OnSysExByteCaller>(midi_app_index(), sysex_byte) &&
+      !has_raw_byte_handler()) {
+    SendNow(sysex_byte);
+  }
+}
+
+/* static */
+inline void App::OnClock(uint8_t clock_mode) {
+  AppRegistry::Dispatch<OnClockCaller>(midi_app_index(), clock_mode);
+}
+
+/* static */
+inline void App::OnStart() {
+  AppRegistry::Dispatch<OnStartCaller>(midi_app_index());
+}
+
+/* static */
+inline void App::OnContinue() {
+  AppRegistry::Dispatch<OnContinueCaller>(midi_app_index());
+}
+
+/* static */
+inline void App::OnStop() {
+  AppRegistry::Dispatch<OnStopCaller>(midi_app_index());
+}
+
+/* static */
+inline void App::OnSongPosition(uint16_t position) {
+  AppRegistry::Dispatch<OnSongPositionCaller>(midi_app_index(), position);
+}
+
+/* static */
+inline void App::OnQuarterFrame(uint8_t data) {
+  AppRegistry::Dispatch<OnQuarterFrameCaller>(midi_app_index(), data);
+}
+
+/* static */
+inline bool App::CheckChannel(uint8_t channel) {
+  return AppRegistry::Dispatch<CheckChannelCaller>(midi_app_index(), channel);
+}
+
+/* static */
+inline void App::OnRawByte(uint8_t byte) {
+  AppRegistry::Dispatch<OnRawByteCaller>(midi_app_index(), byte);
+}
+
+/* static */
+inline bool App::has_raw_byte_handler() {
+  return AppRegistry::Dispatch<OnRawByteRegistered>(midi_app_index());
+}
+
+/* static */
+inline void App::OnRawMidiData(
+    uint8_t status, uint8_t* data, uint8_t data_size) {
+  AppRegistry::Dispatch<OnRawMidiDataCaller>(
+      midi_app_index(), status, data, data_size);
+}
+
+#endif  // STATIC_APP_DISPATCH
+
+}  // namespace midipal
+
+#endif  // MIDIPAL_APP_REGISTRY_H_
@@ -19,6 +19,8 @@
 
 #include "midipal/apps/app_selector.h"
 
+#include <avr/interrupt.h>
+
 #include "avrlib/string.h"
 #include "avrlib/watchdog_timer.h"
 
@@ -26,6 +28,7 @@
 #include "midi/midi_constants.h"
 
 #include "midipal/display.h"
+#include "midipal/settings_store.h"
 #include "midipal/sysex_handler.h"
 #include "midipal/ui.h"
 
@@ -55,6 +58,8 @@ const AppInfo AppSelector::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   &OnRawByte, // void (*OnRawByte)(uint8_t);
   nullptr, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -100,7 +105,9 @@ uint8_t AppSelector::OnClick() {
     // Backup
     sysex_handler.SendBlock(nullptr, 0);
   } else if (selected_item_ == App::num_apps() + 2) {
-    // Factory reset.
+    // Factory reset. The apps share the arena: the handlers of the app being
+    // reset must not run on the settings of another one until the restart.
+    cli();
     for (uint8_t i = 1; i < App::num_apps(); ++i) {
       App::Launch(i);
       App::ResetToFactorySettings();
@@ -111,6 +118,7 @@ uint8_t AppSelector::OnClick() {
     active_app() = selected_item_;
   }
   App::SaveSettings();
+  SettingsStore::Flush();
   SystemReset(100);
   return 1;
 }
@@ -134,10 +142,9 @@ uint8_t AppSelector::OnRedraw() {
         STR_RES_NOTENUKE + selected_item_ - App::num_apps(),
         &line_buffer[0], 8);
   } else {
-    App::Launch(selected_item_);
-    ResourcesManager::LoadStringResource(App::app_name(), &line_buffer[0], 8);
+    ResourcesManager::LoadStringResource(
+        App::app_name(selected_item_), &line_buffer[0], 8);
   }
-  App::Launch(0);
   AlignLeft(&line_buffer[0], 8);
   Ui::RefreshScreen();
   return 1;
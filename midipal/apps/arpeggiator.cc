@@ -41,7 +41,7 @@ const uint8_t arpeggiator_factory_data[Arpeggiator::Parameter::COUNT] PROGMEM =
 };
 
 /* <static> */
-uint8_t Arpeggiator::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(Arpeggiator);
 
 bool Arpeggiator::running_;
 uint8_t Arpeggiator::midi_clock_prescaler_;
@@ -70,6 +70,8 @@ const AppInfo Arpeggiator::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
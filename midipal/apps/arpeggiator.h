@@ -21,6 +21,7 @@
 #define MIDIPAL_APPS_ARPEGGIATOR_H_
 
 #include "midipal/app.h"
+#include "midipal/note_stack.h"
 
 namespace midipal {
 namespace apps{
@@ -45,7 +46,8 @@ public:
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS_AND_TABLES(
+      Parameter::COUNT, kNoteStackArenaOffset, kNoteStackArenaEnd);
 
   static void OnInit();
   static void OnRawMidiData(uint8_t status, uint8_t* data, uint8_t data_size);
@@ -23,6 +23,7 @@
 
 #include "midipal/clock.h"
 #include "midipal/display.h"
+#include "midipal/engine.h"
 #include "midipal/ui.h"
 
 namespace midipal {
@@ -39,6 +40,9 @@ uint32_t BpmMeter::num_ticks_;
 /* static */
 uint32_t BpmMeter::clock_;
 
+/* static */
+uint16_t BpmMeter::first_tick_age_;
+
 /* static */
 uint8_t BpmMeter::active_page_;
 
@@ -60,6 +64,8 @@ const AppInfo BpmMeter::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   &OnRawByte, // void (*OnRawByte)(uint8_t);
   nullptr, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -96,10 +102,14 @@ void BpmMeter::Reset() {
 /* static */
 void BpmMeter::OnClock(uint8_t clock_mode) {
   if (clock_mode == CLOCK_MODE_EXTERNAL) {
+    // Time the ticks from their arrival rather than from when they are
+    // handled.
+    uint16_t age = Engine::event_age();
     if (num_ticks_ == 0) {
       Clock::Reset();
+      first_tick_age_ = age;
     }
-    clock_ = Clock::value();
+    clock_ = Clock::value() + first_tick_age_ - age;
     ++num_ticks_;
   }
 }
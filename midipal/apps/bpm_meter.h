@@ -55,6 +55,7 @@ class BpmMeter {
 
   static uint32_t num_ticks_;
   static uint32_t clock_;
+  static uint16_t first_tick_age_;
   static uint8_t active_page_;
   static uint8_t refresh_bpm_;
   
@@ -33,7 +33,7 @@ const uint8_t CcKnob::factory_data[Parameter::COUNT] PROGMEM = {
 };
 
 /* Check: this is zero-initialised by being in the .bss area? */
-uint8_t CcKnob::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(CcKnob);
 
 
 /* static */
@@ -51,6 +51,8 @@ const AppInfo CcKnob::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
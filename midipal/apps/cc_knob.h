@@ -38,7 +38,7 @@ public:
   };
 
   // holds all the settings in an array to enable pointer arithmetic
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS(Parameter::COUNT);
   static const uint8_t factory_data[Parameter::COUNT] PROGMEM;
   static const AppInfo app_info_ PROGMEM;
 
@@ -34,7 +34,7 @@ const uint8_t chord_memory_factory_data[ChordMemory::Parameter::COUNT] PROGMEM =
 };
 
 /* static */
-uint8_t ChordMemory::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(ChordMemory);
 
 /* static */
 //uint8_t ChordMemory::root_;
@@ -54,6 +54,8 @@ const AppInfo ChordMemory::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -37,7 +37,7 @@ class ChordMemory {
     COUNT = chord_data_end_
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS(Parameter::COUNT);
 
   static void OnInit();
   static void OnRawMidiData(uint8_t status, uint8_t* data, uint8_t data_size);
@@ -29,7 +29,7 @@ static const uint8_t clock_divider_factory_data[ClockDivider::Parameter::COUNT]
 };
 
 /* static */
-uint8_t ClockDivider::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(ClockDivider);
 
 /* static */
 uint8_t ClockDivider::counter_;
@@ -56,6 +56,8 @@ const AppInfo ClockDivider::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   &OnRawByte, // void (*OnRawByte)(uint8_t);
   nullptr, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
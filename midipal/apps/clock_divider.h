@@ -33,7 +33,7 @@ class ClockDivider {
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS(Parameter::COUNT);
 
   static void OnInit();
   static void OnRawByte(uint8_t byte);
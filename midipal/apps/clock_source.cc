@@ -34,7 +34,7 @@ static const uint8_t clock_source_factory_data[ClockSource::Parameter::COUNT] PR
 };
 
 /* static */
-uint8_t ClockSource::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(ClockSource);
 /* static */
 uint8_t ClockSource::num_taps_;
 /* static */
@@ -55,6 +55,8 @@ const AppInfo ClockSource::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   &OnRawByte, // void (*OnRawByte)(uint8_t);
   nullptr, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
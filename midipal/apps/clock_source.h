@@ -37,7 +37,7 @@ class ClockSource {
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS(Parameter::COUNT);
 
   static void OnInit();
   static void OnStart();
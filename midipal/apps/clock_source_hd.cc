@@ -37,7 +37,7 @@ const uint8_t ClockSourceHD::factory_data[Parameter::COUNT] PROGMEM = {
   0, 120, 0, 0, 0
 };
 
-uint8_t ClockSourceHD::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(ClockSourceHD);
 
 /* static */
 uint8_t ClockSourceHD::num_taps_;
@@ -60,6 +60,8 @@ const AppInfo ClockSourceHD::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   &OnRawByte, // void (*OnRawByte)(uint8_t);
   nullptr, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
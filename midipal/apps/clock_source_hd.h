@@ -37,7 +37,7 @@ class ClockSourceHD {
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS(Parameter::COUNT);
   static const uint8_t factory_data[Parameter::COUNT] PROGMEM;
   static const AppInfo app_info_ PROGMEM;
 
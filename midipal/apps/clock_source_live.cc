@@ -24,6 +24,7 @@
 
 #include "midipal/clock.h"
 #include "midipal/display.h"
+#include "midipal/engine.h"
 #include "midipal/ui.h"
 
 namespace midipal {
@@ -34,7 +35,7 @@ const uint8_t ClockSourceLive::factory_data[Parameter::COUNT] PROGMEM = {
 };
 
 /* static */
-uint8_t ClockSourceLive::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(ClockSourceLive);
 
 /* static */
 uint8_t ClockSourceLive::num_ticks_;
@@ -42,6 +43,9 @@ uint8_t ClockSourceLive::num_ticks_;
 /* static */
 uint32_t ClockSourceLive::elapsed_time_;
 
+/* static */
+uint16_t ClockSourceLive::first_tick_age_;
+
 /* static */
 const AppInfo ClockSourceLive::app_info_ PROGMEM = {
   &OnInit, // void (*OnInit)();
@@ -57,6 +61,8 @@ const AppInfo ClockSourceLive::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   &OnRawByte, // void (*OnRawByte)(uint8_t);
   nullptr, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -122,9 +128,13 @@ void ClockSourceLive::OnRawByte(uint8_t byte) {
   if (byte == 0xf8) {
     ++num_ticks_;
     if (num_ticks_ == 192) {
-      SetParameter(1, avrlib::Clip(18750000 * 8 / Clock::value(), 10_u8, 255_u8));
+      // Timed from the arrival of the ticks, as in the bpm meter.
+      uint16_t age = Engine::event_age();
+      uint32_t t = Clock::value() + first_tick_age_ - age;
+      SetParameter(1, avrlib::Clip(18750000 * 8 / t, 10_u8, 255_u8));
       num_ticks_ = 0;
       Clock::Reset();
+      first_tick_age_ = age;
     }
   }
 }
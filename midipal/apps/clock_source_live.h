@@ -38,7 +38,7 @@ class ClockSourceLive {
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS(Parameter::COUNT);
   static const uint8_t factory_data[Parameter::COUNT] PROGMEM;
   static const AppInfo app_info_ PROGMEM;
 
@@ -88,6 +88,7 @@ class ClockSourceLive {
   static uint8_t num_taps_;
   static uint8_t num_ticks_;
   static uint32_t elapsed_time_;
+  static uint16_t first_tick_age_;
   
   DISALLOW_COPY_AND_ASSIGN(ClockSourceLive);
 };
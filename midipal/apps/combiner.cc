@@ -31,7 +31,7 @@ const uint8_t combiner_factory_data[Combiner::Parameter::COUNT] PROGMEM = {
 };
 
 /* static */
-uint8_t Combiner::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(Combiner);
 
 /* static */
 const AppInfo Combiner::app_info_ PROGMEM = {
@@ -48,6 +48,8 @@ const AppInfo Combiner::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
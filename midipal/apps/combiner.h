@@ -35,7 +35,7 @@ class Combiner {
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS(Parameter::COUNT);
 
   static void OnInit();
   static void OnRawMidiData(uint8_t status, uint8_t* data, uint8_t data_size);
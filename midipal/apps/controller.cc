@@ -27,7 +27,7 @@ namespace midipal {
 namespace apps{
 
 /* static */
-uint8_t Controller::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(Controller);
 
 const uint8_t Controller::factory_data[Parameter::COUNT] PROGMEM = {
   0, 7, 10, 74, 71, 73, 80, 72, 91
@@ -48,6 +48,8 @@ const AppInfo Controller::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
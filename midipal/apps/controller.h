@@ -36,7 +36,7 @@ class Controller {
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS(Parameter::COUNT);
   static const uint8_t factory_data[Parameter::COUNT] PROGMEM;
   static const AppInfo app_info_ PROGMEM;
 
@@ -43,7 +43,7 @@ const uint8_t Delay::factory_data[Delay::Parameter::COUNT] PROGMEM = {
 
 /* Static vars */
 /* Check: this is zero-initialised by being in the .bss area? */
-uint8_t Delay::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(Delay);
 uint8_t Delay::running_;
 uint8_t Delay::velocity_factor_reverse_log_;
 
@@ -62,6 +62,8 @@ const AppInfo Delay::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -174,12 +176,8 @@ void Delay::SendEchoes() {
     if (entry.when) {
       break;
     }
-    if (entry.note != EventScheduler::kZombieSlot) {
-      if (entry.velocity == 0) {
-        App::Send3(noteOffFor(channel()), entry.note, 0);
-      } else {
-        App::Send3(noteOnFor(channel()), entry.note, entry.velocity);
-      }
+    App::SendScheduledEvent(entry, channel());
+    if (!entry.status) {
       ScheduleEchoes(entry.note, entry.velocity, entry.tag);
     }
     current = entry.next;
@@ -38,7 +38,7 @@ const uint8_t Dispatcher::factory_data[Parameter::COUNT] PROGMEM = {
 };
 
 /* static */
-uint8_t Dispatcher::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(Dispatcher);
 
 /* static */
 uint8_t Dispatcher::counter_;
@@ -58,6 +58,8 @@ const AppInfo Dispatcher::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -121,32 +123,40 @@ void Dispatcher::OnNoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
   if (channel != input_channel()) {
     return;
   }
+  uint8_t voice = 0xff;
   switch (mode()) {
     case DISPATCHER_CYCLIC:
       ++counter_;
       if (counter_ >= num_voices()) {
         counter_ = 0;
       }
-      note_map.Put(note, counter_);
+      voice = counter_;
       break;
 
     case DISPATCHER_POLYPHONIC_ALLOCATOR:
       voice_allocator.set_size(num_voices());
-      note_map.Put(note, voice_allocator.NoteOn(note));
+      voice = voice_allocator.NoteOn(note);
       break;
       
     case DISPATCHER_RANDOM:
-      note_map.Put(note, Random::GetByte() % num_voices());
+      voice = Random::GetByte() % num_voices();
       break;
     
     case DISPATCHER_STACK:
-      note_map.Put(note, 0xff);
+      voice = 0xff;
       break;
       
     case DISPATCHER_VELOCITY:
-      note_map.Put(note, U8U8MulShift8(velocity << 1, num_voices()));
+      voice = U8U8MulShift8(velocity << 1, num_voices());
       break;
   }
+  NoteMapEntry evicted = note_map().Put(note, voice);
+  if (evicted.note != 0xff) {
+    // The map had to forget a held note: release it now rather than leave
+    // it hanging.
+    VoiceAllocator::NoteOff(evicted.note);
+    SendToVoice(0x80, evicted.value, evicted.note, 0);
+  }
   SendMessage(0x90, channel, note, velocity);
 }
 
@@ -168,18 +178,23 @@ void Dispatcher::OnNoteAftertouch(uint8_t channel, uint8_t note, uint8_t velocit
 
 /* static */
 void Dispatcher::SendMessage(uint8_t message, uint8_t channel, uint8_t note, uint8_t velocity) {
-  NoteMapEntry* entry = note_map.Find(note);
-  if (entry) {
-    if (entry-> value == 0xff) {
-      for (uint8_t i = 0; i < num_voices(); i += polyphony_voices()) {
-        App::Send3(byteOr(message, map_channel(i)), note, velocity);
-      }
-    } else {
-      App::Send3(byteOr(message, map_channel(entry->value)), note, velocity);
-    }
+  uint8_t voice;
+  if (note_map().Find(note, &voice)) {
+    SendToVoice(message, voice, note, velocity);
     if (message == 0x80) {
-      entry->note = 0xff;
+      note_map().Remove(note);
+    }
+  }
+}
+
+/* static */
+void Dispatcher::SendToVoice(uint8_t message, uint8_t voice, uint8_t note, uint8_t velocity) {
+  if (voice == 0xff) {
+    for (uint8_t i = 0; i < num_voices(); i += polyphony_voices()) {
+      App::Send3(byteOr(message, map_channel(i)), note, velocity);
     }
+  } else {
+    App::Send3(byteOr(message, map_channel(voice)), note, velocity);
   }
 }
 
@@ -22,6 +22,7 @@
 
 #include "midipal/app.h"
 #include "midipal/note_map.h"
+#include "midipal/voice_allocator.h"
 
 namespace midipal {
 namespace apps{
@@ -37,7 +38,8 @@ class Dispatcher {
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS_AND_TABLES(
+      Parameter::COUNT, kNoteMapArenaOffset, kVoiceAllocatorArenaEnd);
   static const uint8_t factory_data[Parameter::COUNT] PROGMEM;
   static const AppInfo app_info_ PROGMEM;
 
@@ -58,6 +60,7 @@ class Dispatcher {
   };
 
   static void SendMessage(uint8_t message, uint8_t channel, uint8_t note, uint8_t velocity);
+  static void SendToVoice(uint8_t message, uint8_t voice, uint8_t note, uint8_t velocity);
   static uint8_t map_channel(uint8_t index);
 
   static inline uint8_t& ParameterValue(Parameter key) {
@@ -32,7 +32,7 @@ const uint8_t DrumPatternGenerator::factory_data[Parameter::COUNT] PROGMEM = {
   0, 0, 120, 0, 0, 9, 36, 40, 42, 56
 };
 
-uint8_t DrumPatternGenerator::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(DrumPatternGenerator);
 
 // <static>
 uint8_t DrumPatternGenerator::running_;
@@ -67,6 +67,8 @@ const AppInfo DrumPatternGenerator::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  &OnSongPosition, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -150,6 +152,23 @@ void DrumPatternGenerator::OnStop() {
   AllNotesOff();
 }
 
+/* static */
+void DrumPatternGenerator::OnSongPosition(uint16_t position) {
+  if (clk_mode() == CLOCK_MODE_INTERNAL) {
+    return;
+  }
+  // A step lasts a sixteenth note, like the unit of the song position.
+  tick_ = 0;
+  step_count_ = position % 16;
+  bitmask_ = 1 << step_count_;
+  for (uint8_t part = 0; part < kNumDrumParts; ++part) {
+    uint8_t size = ResourcesManager::Lookup<uint16_t, uint8_t>(
+        sizes, euclidian_num_steps_[part]);
+    euclidian_step_count_[part] = size ? position % size : 0;
+    euclidian_bitmask_[part] = 1 << euclidian_step_count_[part];
+  }
+}
+
 /* static */
 void DrumPatternGenerator::OnClock(uint8_t clock_source) {
   if (clk_mode() == clock_source && running_) {
@@ -21,6 +21,7 @@
 #define MIDIPAL_APPS_DRUM_PATTERN_GENERATOR_H_
 
 #include "midipal/app.h"
+#include "midipal/note_stack.h"
 
 namespace midipal {
 namespace apps{
@@ -42,7 +43,8 @@ class DrumPatternGenerator {
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS_AND_TABLES(
+      Parameter::COUNT, kNoteStackArenaOffset, kNoteStackArenaEnd);
   static const uint8_t factory_data[Parameter::COUNT] PROGMEM;
   static const AppInfo app_info_ PROGMEM;
 
@@ -54,6 +56,7 @@ class DrumPatternGenerator {
   static void OnContinue();
   static void OnStart();
   static void OnStop();
+  static void OnSongPosition(uint16_t position);
   static void OnClock(uint8_t clock_mode);
 
   static void SetParameter(uint8_t key, uint8_t value);
@@ -36,7 +36,7 @@ const uint8_t Filter::factory_data[Parameter::COUNT] PROGMEM = {
 };
 
 /* static */
-uint8_t Filter::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(Filter);
 
 /* static */
 const AppInfo Filter::app_info_ PROGMEM = {
@@ -53,6 +53,8 @@ const AppInfo Filter::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
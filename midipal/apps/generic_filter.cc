@@ -37,7 +37,7 @@ using namespace avrlib;
 const uint8_t GenericFilter::factory_data[Parameter::COUNT] PROGMEM = { 0 };
 
 /* static */
-uint8_t GenericFilter::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(GenericFilter);
 
 /* static */
 Modifier GenericFilter::modifiers_[kNumModifiers];
@@ -57,6 +57,8 @@ const AppInfo GenericFilter::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
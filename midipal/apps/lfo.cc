@@ -41,7 +41,7 @@ const uint8_t Lfo::factory_data[Parameter::COUNT] PROGMEM = {
 };
 
 /* <static> */
-uint8_t Lfo::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(Lfo);
 
 uint16_t Lfo::phase_[kNumLfos];
 uint16_t Lfo::phase_increment_[kNumLfos];
@@ -65,6 +65,8 @@ const AppInfo Lfo::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
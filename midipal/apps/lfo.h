@@ -21,6 +21,7 @@
 #define MIDIPAL_APPS_LFO_H_
 
 #include "midipal/app.h"
+#include "midipal/note_stack.h"
 
 namespace midipal {
 namespace apps{
@@ -58,7 +59,8 @@ class Lfo {
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS_AND_TABLES(
+      Parameter::COUNT, kNoteStackArenaOffset, kNoteStackArenaEnd);
   static const uint8_t factory_data[Parameter::COUNT] PROGMEM;
   static const AppInfo app_info_ PROGMEM;
 
@@ -32,7 +32,7 @@ using namespace avrlib;
 static const uint8_t monitor_factory_data[Monitor::Parameter::COUNT] PROGMEM = { 0 };
 
 /* static */
-uint8_t Monitor::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(Monitor);
 /* static */
 uint8_t Monitor::idle_counter_;
 
@@ -51,6 +51,8 @@ const AppInfo Monitor::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   &CheckChannel, // bool *(CheckChannel)(uint8_t);
   &OnRawByte, // void (*OnRawByte)(uint8_t);
   nullptr, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -32,7 +32,7 @@ class Monitor {
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS(Parameter::COUNT);
 
   static void OnInit();
 
@@ -46,7 +46,7 @@ const uint8_t PolySequencer::factory_data[Parameter::COUNT] PROGMEM = {
 };
 
 /* <static> */
-uint8_t PolySequencer::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(PolySequencer);
 
 uint8_t PolySequencer::midi_clock_prescaler_;
 uint8_t PolySequencer::tick_;
@@ -75,6 +75,8 @@ const AppInfo PolySequencer::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  &OnSongPosition, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -218,10 +220,24 @@ void PolySequencer::OnStop() {
   }
 }
 
+/* static */
+void PolySequencer::OnSongPosition(uint16_t position) {
+  if (clk_mode() != CLOCK_MODE_INTERNAL) {
+    App::LocateSongPosition(
+        position, midi_clock_prescaler_, num_steps(), &tick_, &step_);
+  }
+}
+
 /* static */
 void PolySequencer::OnContinue() {
   if (!running()) {
+    // Resume from the position reached when stopped, or set by a song
+    // position pointer.
+    uint8_t tick = tick_;
+    uint8_t step = step_;
     Start();
+    tick_ = tick;
+    step_ = step;
   }
 }
 
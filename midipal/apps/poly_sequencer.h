@@ -48,7 +48,7 @@ class PolySequencer {
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS(Parameter::COUNT);
   static const uint8_t factory_data[Parameter::COUNT] PROGMEM;
   static const AppInfo app_info_ PROGMEM;
 
@@ -60,6 +60,7 @@ class PolySequencer {
   static void OnContinue();
   static void OnStart();
   static void OnStop();
+  static void OnSongPosition(uint16_t position);
   static void OnClock(uint8_t clock_mode);
 
   static uint8_t OnClick();
@@ -37,7 +37,7 @@ const uint8_t Randomizer::factory_data[Parameter::COUNT] PROGMEM = {
 };
 
 /* static */
-uint8_t Randomizer::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(Randomizer);
 
 /* static */
 const AppInfo Randomizer::app_info_ PROGMEM = {
@@ -54,6 +54,8 @@ const AppInfo Randomizer::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -136,7 +138,10 @@ void Randomizer::OnNoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
       new_note = U8Mix(note, randomU7(), ScaleModulationAmount(note_amount()));
     }
 
-    note_map.Put(note, new_note);
+    NoteMapEntry evicted = note_map().Put(note, new_note);
+    if (evicted.note != 0xff) {
+      App::Send3(noteOffFor(channel), evicted.value, 0);
+    }
 
     App::Send3(noteOnFor(channel), new_note, velocity);
   }
@@ -158,11 +163,11 @@ void Randomizer::SendMessage(uint8_t message, uint8_t channel, uint8_t note, uin
   if (!isActiveChannel(channel)) {
     App::Send3(messageOnChannel, note, velocity);
   } else {
-    NoteMapEntry* entry = note_map.Find(note);
-    if (entry) {
-      App::Send3(messageOnChannel, entry->value, velocity);
+    uint8_t mapped_note;
+    if (note_map().Find(note, &mapped_note)) {
+      App::Send3(messageOnChannel, mapped_note, velocity);
       if (message == MIDI_NOTE_OFF) {
-        entry->note = 0xff;
+        note_map().Remove(note);
       }
     }
   }  
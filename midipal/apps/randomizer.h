@@ -21,7 +21,7 @@
 #define MIDIPAL_APPS_RANDOMIZER_H_
 
 #include "midipal/app.h"
-#include "midipal/note_map.h"
+#include "midipal/notes.h"
 
 namespace midipal {
 namespace apps {
@@ -41,7 +41,8 @@ public:
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS_AND_TABLES(
+      Parameter::COUNT, kNoteMapArenaOffset, kNoteMapArenaEnd);
   static const uint8_t factory_data[Parameter::COUNT] PROGMEM;
   static const AppInfo app_info_ PROGMEM;
 
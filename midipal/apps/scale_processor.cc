@@ -26,7 +26,6 @@
 
 #include "midipal/clock.h"
 #include "midipal/event_scheduler.h"
-#include "midipal/note_stack.h"
 #include "midipal/notes.h"
 #include "midipal/ui.h"
 
@@ -48,8 +47,11 @@ const uint8_t ScaleProcessor::factory_data[Parameter::COUNT] PROGMEM = {
 };
 
 /* <static> */
-uint8_t ScaleProcessor::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(ScaleProcessor);
 
+#ifdef APP_PIPELINE
+PooledNoteStack<kNoteStackSize> ScaleProcessor::held_notes_;
+#endif  // APP_PIPELINE
 uint8_t ScaleProcessor::lowest_note_;
 uint8_t ScaleProcessor::previous_note_;
 uint8_t ScaleProcessor::voice_2_note_;
@@ -71,6 +73,8 @@ const AppInfo ScaleProcessor::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -99,6 +103,7 @@ void ScaleProcessor::OnInit() {
   Ui::AddPage(STR_RES_HRM, STR_RES_OFF_, 0, 4);
   previous_note_ = 0;
   flip_ = false;
+  held_notes().Init();
 }
 
 inline bool shouldForwardData(uint8_t status, uint8_t channel) {
@@ -117,8 +122,8 @@ void ScaleProcessor::OnRawMidiData(uint8_t status, uint8_t* data, uint8_t data_s
 /* static */
 void ScaleProcessor::OnNoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
   if (channel == ScaleProcessor::channel()) {
-    NoteStack::NoteOn(note, velocity);
-    lowest_note_ = FactorizeMidiNote(NoteStack::sorted_note(0).note).note;
+    held_notes().NoteOn(note, velocity);
+    lowest_note_ = FactorizeMidiNote(held_notes().sorted_note(0).note).note;
     ProcessNoteMessage(MIDI_NOTE_ON, note, velocity);
   }
 }
@@ -126,7 +131,7 @@ void ScaleProcessor::OnNoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
 /* static */
 void ScaleProcessor::OnNoteOff(uint8_t channel, uint8_t note, uint8_t velocity) {
   if (channel == ScaleProcessor::channel()) {
-    NoteStack::NoteOff(note);
+    held_notes().NoteOff(note);
     ProcessNoteMessage(MIDI_NOTE_OFF, note, velocity);
   }
 }
@@ -146,11 +151,10 @@ void ScaleProcessor::ProcessNoteMessage(uint8_t message, uint8_t note, uint8_t v
   if (root() == 24) {
     // Dynamic root mode.
     if (message == MIDI_NOTE_ON) {
-      note_map.Put(note, Constraint(note, lowest_note_, scale()));
+      note_map().Put(note, Constraint(note, lowest_note_, scale()));
     }
-    NoteMapEntry* entry = note_map.Find(note);
-    if (entry) {
-      auto value = entry->value;
+    uint8_t value;
+    if (note_map().Find(note, &value)) {
       App::Send3(messageByte, value, velocity);
       if (voice_1()) {
         App::Send3(messageByte, Transpose(value, voice_1()), velocity);
@@ -201,14 +205,14 @@ void ScaleProcessor::ProcessNoteMessage(uint8_t message, uint8_t note, uint8_t v
       }
       previous_note_ = note;
       voice_2_note_ = Constraint(voice_2_note_, root(), scale());
-      note_map.Put(note, voice_2_note_);
+      note_map().Put(note, voice_2_note_);
     }
     
-    NoteMapEntry* entry = note_map.Find(note);
-    if (entry) {
-      App::Send3(messageByte, entry->value, velocity);
+    uint8_t value;
+    if (note_map().Find(note, &value)) {
+      App::Send3(messageByte, value, velocity);
       if (message == MIDI_NOTE_OFF) {
-        entry->note = 0xff;
+        note_map().Remove(note);
       }
     }
   }
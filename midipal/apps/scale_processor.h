@@ -21,6 +21,7 @@
 #define MIDIPAL_APPS_SCALE_PROCESSOR_H_
 
 #include "midipal/app.h"
+#include "midipal/note_stack.h"
 
 namespace midipal {
 namespace apps{
@@ -38,7 +39,8 @@ class ScaleProcessor {
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS_AND_TABLES(
+      Parameter::COUNT, kNoteMapArenaOffset, kNoteStackArenaEnd);
   static const uint8_t factory_data[Parameter::COUNT] PROGMEM;
   static const AppInfo app_info_ PROGMEM;
 
@@ -78,6 +80,18 @@ class ScaleProcessor {
     return ParameterValue(voice_2_);
   }
 
+  static PooledNoteStack<kNoteStackSize>& held_notes() {
+#ifdef APP_PIPELINE
+    return held_notes_;
+#else
+    return NoteStack::stack();
+#endif  // APP_PIPELINE
+  }
+
+#ifdef APP_PIPELINE
+  // Not the shared NoteStack: the arpeggiator may be using it downstream.
+  static PooledNoteStack<kNoteStackSize> held_notes_;
+#endif  // APP_PIPELINE
   static uint8_t lowest_note_;
   static uint8_t previous_note_;
   static uint8_t voice_2_note_;
@@ -81,7 +81,7 @@ const uint8_t Sequencer::factory_data[Parameter::COUNT] PROGMEM = {
 };
 
 /* <static> */
-uint8_t Sequencer::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(Sequencer);
 
 uint8_t Sequencer::midi_clock_prescaler_;
 uint8_t Sequencer::tick_;
@@ -105,6 +105,8 @@ const AppInfo Sequencer::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  &OnSongPosition, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -196,6 +198,14 @@ void Sequencer::OnStop() {
   }
 }
 
+/* static */
+void Sequencer::OnSongPosition(uint16_t position) {
+  if (!usingInternalClock()) {
+    App::LocateSongPosition(
+        position, midi_clock_prescaler_, num_steps(), &tick_, &playback_step_);
+  }
+}
+
 /* static */
 void Sequencer::OnContinue() {
   if (!usingInternalClock()) {
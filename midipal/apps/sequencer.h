@@ -59,7 +59,7 @@ private:
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS(Parameter::COUNT);
   static const uint8_t factory_data[Parameter::COUNT] PROGMEM;
   static const AppInfo app_info_ PROGMEM;
 
@@ -71,6 +71,7 @@ private:
   static void OnContinue();
   static void OnStart();
   static void OnStop();
+  static void OnSongPosition(uint16_t position);
   static void OnClock(uint8_t clock_mode);
   
   static void SetParameter(uint8_t key, uint8_t value);
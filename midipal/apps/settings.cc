@@ -22,13 +22,14 @@
 
 #include "midi/midi.h"
 
+#include "midipal/stack_monitor.h"
 #include "midipal/ui.h"
 
 namespace midipal {
 namespace apps{
 
 static const uint8_t settings_factory_data[Settings::Parameter::COUNT] PROGMEM = {
-  0, 0, 16, 84, 12,
+  0, 0, 16, 84, 12, 0,
 };
 
 /* static */
@@ -49,6 +50,8 @@ const AppInfo Settings::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   &OnRawByte, // void (*OnRawByte)(uint8_t);
   nullptr, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -60,8 +63,8 @@ const AppInfo Settings::app_info_ PROGMEM = {
   nullptr, // uint8_t (*OnPot)(uint8_t, uint8_t);
 #endif
   nullptr, // uint8_t (*OnRedraw)();
-  nullptr, // void (*SetParameter)(uint8_t, uint8_t);
-  nullptr, // uint8_t (*GetParameter)(uint8_t);
+  &SetParameter, // void (*SetParameter)(uint8_t, uint8_t);
+  &GetParameter, // uint8_t (*GetParameter)(uint8_t);
   nullptr, // uint8_t (*CheckPageStatus)(uint8_t);
   Parameter::COUNT, // settings_size
   SETTINGS_SYSTEM_SETTINGS, // settings_offset
@@ -78,6 +81,23 @@ void Settings::OnInit() {
   Ui::AddPage(STR_RES_CLC, UNIT_INTEGER, 1, 16);
   Ui::AddPage(STR_RES_CLN, UNIT_NOTE, 24, 108);
   Ui::AddPage(STR_RES_DIV, STR_RES_2_1, 0, 16);
+  Ui::AddPage(STR_RES_STK, UNIT_INTEGER, 0, 255);
+}
+
+/* static */
+void Settings::SetParameter(uint8_t key, uint8_t value) {
+  if (key != free_stack_) {
+    settings[key] = value;
+  }
+}
+
+/* static */
+uint8_t Settings::GetParameter(uint8_t key) {
+  if (key == free_stack_) {
+    uint16_t free = StackMonitor::min_free();
+    return free > 255 ? 255 : free;
+  }
+  return settings[key];
 }
 
 /* static */
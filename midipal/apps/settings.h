@@ -34,6 +34,7 @@ class Settings {
     note_clock_channel_,
     note_clock_note_,
     note_clock_ticks_,
+    free_stack_,  // Read only.
     COUNT
   };
 
@@ -42,6 +43,8 @@ class Settings {
 
   static void OnInit();
   static void OnRawByte(uint8_t byte);
+  static void SetParameter(uint8_t key, uint8_t value);
+  static uint8_t GetParameter(uint8_t key);
  
   static inline uint8_t& remote_control_channel() {
     return ParameterValue(remote_control_channel_);
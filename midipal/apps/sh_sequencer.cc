@@ -42,7 +42,7 @@ const uint8_t ShSequencer::factory_data[Parameter::COUNT] PROGMEM = {
 };
 
 /* <static> */
-uint8_t ShSequencer::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(ShSequencer);
 
 
 uint8_t ShSequencer::midi_clock_prescaler_;
@@ -69,6 +69,8 @@ const AppInfo ShSequencer::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  &OnSongPosition, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool (*CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -218,10 +220,28 @@ void ShSequencer::OnStop() {
   }
 }
 
+/* static */
+void ShSequencer::OnSongPosition(uint16_t position) {
+  if (!isClockModeInternal()) {
+    App::LocateSongPosition(
+        position,
+        midi_clock_prescaler_,
+        recorded_steps(),
+        &tick_,
+        &playback_step_);
+  }
+}
+
 /* static */
 void ShSequencer::OnContinue() {
   if (!running()) {
+    // Resume from the position reached when stopped, or set by a song
+    // position pointer.
+    uint8_t tick = tick_;
+    uint8_t step = playback_step_;
     Start();
+    tick_ = tick;
+    playback_step_ = step;
   }
 }
 
@@ -52,7 +52,7 @@ public:
     COUNT
   };
 
-  static uint8_t settings[Parameter::COUNT];
+  APP_SETTINGS(Parameter::COUNT);
   static const uint8_t factory_data[Parameter::COUNT] PROGMEM;
   static const AppInfo app_info_ PROGMEM;
 
@@ -64,6 +64,7 @@ public:
   static void OnContinue();
   static void OnStart();
   static void OnStop();
+  static void OnSongPosition(uint16_t position);
   static void OnClock(uint8_t clock_mode);
   
   static void OnControlChange(uint8_t channel, uint8_t cc_num, uint8_t value);
@@ -32,7 +32,7 @@ const uint8_t Splitter::factory_data[Parameter::COUNT] PROGMEM = {
 };
 
 /* static */
-uint8_t Splitter::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(Splitter);
 
 /* static */
 const AppInfo Splitter::app_info_ PROGMEM = {
@@ -49,6 +49,8 @@ const AppInfo Splitter::app_info_ PROGMEM = {
   nullptr, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   nullptr, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
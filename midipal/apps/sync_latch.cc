@@ -37,7 +37,7 @@ const uint8_t SyncLatch::factory_data[Parameter::COUNT] PROGMEM = {
 
 
 /* static */
-uint8_t SyncLatch::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(SyncLatch);
 
 /* static */
 const AppInfo SyncLatch::app_info_ PROGMEM = {
@@ -54,6 +54,8 @@ const AppInfo SyncLatch::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   nullptr, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   &OnRawByte, // void (*OnRawByte)(uint8_t);
   nullptr, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
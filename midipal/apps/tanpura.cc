@@ -37,7 +37,7 @@ const uint8_t Tanpura::factory_data[Parameter::COUNT] PROGMEM = {
 };
 
 /* static */
-uint8_t Tanpura::settings[Parameter::COUNT];
+DEFINE_APP_SETTINGS(Tanpura);
 
 /* <static> */
 uint8_t Tanpura::midi_clock_prescaler_;
@@ -60,6 +60,8 @@ const AppInfo Tanpura::app_info_ PROGMEM = {
   &OnStart, // void (*OnStart)();
   &OnContinue, // void (*OnContinue)();
   &OnStop, // void (*OnStop)();
+  nullptr, // void (*OnSongPosition)(uint16_t);
+  nullptr, // void (*OnQuarterFrame)(uint8_t);
   nullptr, // bool *(CheckChannel)(uint8_t);
   nullptr, // void (*OnRawByte)(uint8_t);
   &OnRawMidiData, // void (*OnRawMidiData)(uint8_t, uint8_t*, uint8_t);
@@ -27,6 +27,9 @@ namespace midipal {
 /* <static> */
 bool Clock::running_;
 uint32_t Clock::clock_;
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+uint16_t Clock::time_;
+#endif  // ENABLE_MAIN_LOOP_EVENTS
 uint16_t Clock::intervals_[kNumStepsInGroovePattern];
 uint16_t Clock::interval_;
 uint8_t Clock::tick_count_;
@@ -57,6 +57,9 @@ class Clock {
 
   static inline uint16_t Tick() {
     clock_ += interval_ + 1;
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+    time_ += interval_ + 1;
+#endif  // ENABLE_MAIN_LOOP_EVENTS
     ++tick_count_;
     if (tick_count_ == kNumTicksPerStep) {
       tick_count_ = 0;
@@ -72,6 +75,13 @@ class Clock {
   static uint32_t value() {
     return clock_;
   }
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+  // Same unit as value(), but never reset, and wrapping around: the queued
+  // events are stamped with it.
+  static inline uint16_t time() {
+    return time_;
+  }
+#endif  // ENABLE_MAIN_LOOP_EVENTS
   
   static void UpdateFractional( uint16_t bpm, uint8_t multiplier, uint8_t divider,
         uint8_t groove_template, uint8_t groove_amount);
@@ -82,6 +92,9 @@ class Clock {
  private:
   static bool running_;
   static uint32_t clock_;  // Counts forever
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+  static uint16_t time_;
+#endif  // ENABLE_MAIN_LOOP_EVENTS
   static uint16_t intervals_[kNumStepsInGroovePattern];
   static uint16_t interval_;
   static uint8_t tick_count_;
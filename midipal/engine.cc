@@ -0,0 +1,202 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Processing of the MIDI stream.
+
+#include "midipal/engine.h"
+
+#include <avr/interrupt.h>
+
+#include "midipal/app.h"
+#include "midipal/apps/settings.h"
+#include "midipal/clock.h"
+#include "midipal/pipeline.h"
+
+namespace midipal {
+
+using namespace midi;
+
+/* static */
+MidiStreamParser<MidiHandler> Engine::parser_;
+
+/* static */
+volatile uint8_t Engine::num_clock_ticks_;
+
+/* static */
+uint8_t Engine::running_status_;
+
+/* static */
+uint8_t Engine::num_running_status_repeats_;
+
+/* static */
+volatile uint8_t Engine::sysex_output_;
+
+/* static */
+volatile uint8_t Engine::parsing_input_;
+
+/* static */
+uint16_t Engine::input_errors_[INPUT_ERROR_LAST];
+
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+/* static */
+uint16_t Engine::event_age_;
+#endif  // ENABLE_MAIN_LOOP_EVENTS
+
+/* static */
+bool Engine::PushInputByte(uint8_t byte) {
+  if (byte == 0xfe && apps::Settings::filter_active_sensing()) {
+    return false;
+  }
+#ifdef APP_PIPELINE
+  // Input enters the chain at the first stage.
+  uint8_t stage = Pipeline::Select(0);
+  parser_.PushByte(byte);
+  Pipeline::Select(stage);
+#else
+  parser_.PushByte(byte);
+#endif  // APP_PIPELINE
+  return true;
+}
+
+/* static */
+bool Engine::ProcessInputBuffer() {
+  // TIMER2 does not block interrupts, and can interrupt itself while it is
+  // parsing. The nested pass leaves the bytes to the one it interrupted,
+  // which keeps them in order and the parser in a consistent state. There is
+  // no need to set the flag atomically: a nested pass always returns before
+  // the one it interrupted resumes.
+  if (parsing_input_) {
+    return false;
+  }
+  parsing_input_ = 1;
+  bool accepted = false;
+  for (uint8_t i = 0; i < kMaxInputBytesPerPass; ++i) {
+    if (!MidiInput::Buffer::readable()) {
+      break;
+    }
+    accepted |= PushInputByte(MidiInput::Buffer::ImmediateRead());
+  }
+  parsing_input_ = 0;
+  return accepted;
+}
+
+/* static */
+uint8_t Engine::SnapshotInputErrors(uint8_t* buffer) {
+  uint8_t* p = buffer;
+  uint8_t sreg = SREG;
+  cli();
+  for (uint8_t i = 0; i < INPUT_ERROR_LAST; ++i) {
+    *p++ = input_errors_[i] >> 8;
+    *p++ = input_errors_[i] & 0xff;
+    input_errors_[i] = 0;
+  }
+  SREG = sreg;
+  return p - buffer;
+}
+
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+/* static */
+bool Engine::ProcessEvents() {
+  App::FlushPendingMessage();
+  bool accepted = false;
+  for (uint8_t i = 0; i < kMaxEventsPerPass; ++i) {
+    if (!EventQueue::Buffer::readable()) {
+      break;
+    }
+    uint16_t event = EventQueue::Buffer::ImmediateRead();
+    // TIMER1 updates the clock.
+    uint8_t sreg = SREG;
+    cli();
+    event_age_ = Clock::time() - EventTimes::Buffer::ImmediateRead();
+    SREG = sreg;
+    if (highByte(event) == EVENT_INTERNAL_CLOCK) {
+      ClockApp();
+    } else {
+      accepted |= PushInputByte(lowByte(event));
+    }
+  }
+  event_age_ = 0;
+  return accepted;
+}
+#endif  // ENABLE_MAIN_LOOP_EVENTS
+
+/* static */
+void Engine::OnInternalClockTick() {
+  if (!Clock::running()) {
+    return;
+  }
+#ifdef APP_PIPELINE
+  // Each stage is clocked as it would be on its own: the ones handling the
+  // clock in real time now, the others with the deferred tick.
+  Pipeline::OnInternalClock(true);
+#else
+  if (App::realtime_clock_handling()) {
+    App::OnClock(CLOCK_MODE_INTERNAL);
+    return;
+  }
+#endif  // APP_PIPELINE
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+  PostEvent(EVENT_INTERNAL_CLOCK, 0);
+#else
+  ++num_clock_ticks_;
+#endif  // ENABLE_MAIN_LOOP_EVENTS
+}
+
+/* static */
+void Engine::ProcessClockTicks() {
+  while (num_clock_ticks_) {
+    --num_clock_ticks_;
+    ClockApp();
+  }
+}
+
+/* static */
+void Engine::ClockApp() {
+#ifdef APP_PIPELINE
+  Pipeline::OnInternalClock(false);
+#else
+  App::OnClock(CLOCK_MODE_INTERNAL);
+#endif  // APP_PIPELINE
+}
+
+/* static */
+bool Engine::PopOutputByte(uint8_t* byte) {
+  if (sysex_output_) {
+    return false;
+  }
+  while (MidiHandler::OutputBuffer::readable()) {
+    uint8_t b = MidiHandler::OutputBuffer::ImmediateRead();
+    if (b >= 0xf8) {
+      // Realtime messages do not affect the running status.
+    } else if (b >= 0xf0) {
+      running_status_ = 0;
+    } else if (b >= 0x80) {
+      if (b == running_status_ &&
+          num_running_status_repeats_ < kRunningStatusRefresh) {
+        ++num_running_status_repeats_;
+        continue;
+      }
+      running_status_ = b;
+      num_running_status_repeats_ = 0;
+    }
+    *byte = b;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace midipal
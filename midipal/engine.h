@@ -0,0 +1,209 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Processing of the MIDI stream: input bytes go through the parser to the
+// active app, internal clock ticks go to the app, and the app output lands
+// in MidiHandler::OutputBuffer.
+//
+// None of this touches the UART or the timers - the interrupt handlers in
+// midipal.cc only move bytes in and out, so the same entry points can be
+// driven from a test harness.
+
+#ifndef MIDIPAL_ENGINE_H_
+#define MIDIPAL_ENGINE_H_
+
+#include <avr/interrupt.h>
+
+#include "avrlib/base.h"
+
+#include "midi/midi.h"
+#include "midipal/clock.h"
+#include "midipal/midi_handler.h"
+
+namespace midipal {
+
+static const uint8_t kRunningStatusRefresh = 32;
+static const uint8_t kMaxInputBytesPerPass = 8;
+static const uint8_t kMaxEventsPerPass = 16;
+
+enum InputError {
+  INPUT_ERROR_OVERRUN,  // Byte lost by the UART.
+  INPUT_ERROR_FRAMING,
+  // Byte (or deferred clock tick) lost because the input buffer or event
+  // queue was full.
+  INPUT_ERROR_BUFFER_FULL,
+  INPUT_ERROR_LAST
+};
+
+// Bytes received by the UART receive interrupt, waiting to be parsed.
+struct MidiInput {
+  enum {
+    buffer_size = 32,
+    data_size = 8,
+  };
+  typedef avrlib::RingBuffer<MidiInput> Buffer;
+};
+
+// With -DENABLE_MAIN_LOOP_EVENTS, the interrupts only queue the input bytes
+// and the deferred internal clock ticks, in the order in which they occurred;
+// parsing and the app handlers run from the main loop. Each event is its
+// type in the high byte, and the input byte in the low byte. Clock ticks
+// handled in real time by the app still run from TIMER1.
+enum EventType {
+  EVENT_INPUT_BYTE,
+  EVENT_INTERNAL_CLOCK
+};
+
+struct EventQueue {
+  enum {
+    buffer_size = 32,
+    data_size = 16,
+  };
+  typedef avrlib::RingBuffer<EventQueue> Buffer;
+};
+
+// Clock::time() when each of the queued events was posted, written and read
+// in step with the EventQueue.
+struct EventTimes {
+  enum {
+    buffer_size = 32,
+    data_size = 16,
+  };
+  typedef avrlib::RingBuffer<EventTimes> Buffer;
+};
+
+// Realtime bytes waiting for the UART. They are sent before anything in the
+// output buffer, even between the bytes of a message.
+struct RealtimeOutput {
+  enum {
+    buffer_size = 8,
+    data_size = 8,
+  };
+  typedef avrlib::RingBuffer<RealtimeOutput> Buffer;
+};
+
+class Engine {
+ public:
+  // Parses a byte received on the MIDI input. Returns false if the byte has
+  // been filtered out.
+  static bool PushInputByte(uint8_t byte);
+
+  // Stores a byte received by the UART interrupt, to be parsed later by
+  // ProcessInputBuffer().
+  static inline void BufferInputByte(uint8_t byte) {
+    if (MidiInput::Buffer::writable()) {
+      MidiInput::Buffer::Overwrite(byte);
+    } else {
+      CountInputError(INPUT_ERROR_BUFFER_FULL);
+    }
+  }
+  // Parses at most kMaxInputBytesPerPass bytes from the input buffer. Returns
+  // true if at least one of them has not been filtered out. Does nothing if
+  // called from an interrupt nested in another call.
+  static bool ProcessInputBuffer();
+
+  static inline void CountInputError(InputError error) {
+    if (input_errors_[error] != 0xffff) {
+      ++input_errors_[error];
+    }
+  }
+  // Copies the error counts to buffer and resets them. Returns the number of
+  // bytes written.
+  static uint8_t SnapshotInputErrors(uint8_t* buffer);
+
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+  // Queues an event for ProcessEvents(), stamped with its time of arrival.
+  // Can be called from any interrupt.
+  static inline void PostEvent(EventType type, uint8_t byte) {
+    uint8_t sreg = SREG;
+    cli();
+    if (EventQueue::Buffer::writable()) {
+      EventQueue::Buffer::Overwrite(U16(type) << 8 | byte);
+      EventTimes::Buffer::Overwrite(Clock::time());
+    } else {
+      CountInputError(INPUT_ERROR_BUFFER_FULL);
+    }
+    SREG = sreg;
+  }
+  // Handles at most kMaxEventsPerPass queued events. Returns true if at
+  // least one input byte has not been filtered out.
+  static bool ProcessEvents();
+#endif  // ENABLE_MAIN_LOOP_EVENTS
+  // In the unit of Clock::value(), how long ago the event being handled
+  // arrived: apps timing their input add it back to what they measure. Zero
+  // outside of ProcessEvents(), and without the main loop events, for which
+  // the input is handled as it arrives.
+  static inline uint16_t event_age() {
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+    return event_age_;
+#else
+    return 0;
+#endif  // ENABLE_MAIN_LOOP_EVENTS
+  }
+
+  // Handles a tick of the internal clock, either immediately if the app can
+  // do it in time, or later in ProcessClockTicks() - or ProcessEvents().
+  static void OnInternalClockTick();
+  static void ProcessClockTicks();
+
+  static bool output_readable() {
+    return MidiHandler::OutputBuffer::readable();
+  }
+  // Takes the next byte to transmit from the output buffer. Returns false if
+  // there is none, or while a SysEx message is being written to the UART.
+  // Status bytes repeating the running status are dropped, except once every
+  // kRunningStatusRefresh messages so that a receiver which missed the
+  // previous status byte can recover.
+  static bool PopOutputByte(uint8_t* byte);
+  // To be called whenever a byte other than a realtime message is sent
+  // without going through the output buffer.
+  static void InvalidateRunningStatus() {
+    running_status_ = 0;
+  }
+  // Bracket a SysEx message written to the UART without going through the
+  // output buffer. In between, the interrupt handlers only send realtime
+  // bytes, so that no channel message lands inside the SysEx message.
+  static void BeginSysExOutput() {
+    sysex_output_ = 1;
+    running_status_ = 0;
+  }
+  static void EndSysExOutput() {
+    sysex_output_ = 0;
+    running_status_ = 0;
+  }
+  static bool sysex_output() { return sysex_output_; }
+
+ private:
+  static void ClockApp();
+
+  static midi::MidiStreamParser<MidiHandler> parser_;
+  static volatile uint8_t num_clock_ticks_;
+  static uint8_t running_status_;
+  static uint8_t num_running_status_repeats_;
+  static volatile uint8_t sysex_output_;
+  static volatile uint8_t parsing_input_;
+  static uint16_t input_errors_[INPUT_ERROR_LAST];
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+  static uint16_t event_age_;
+#endif  // ENABLE_MAIN_LOOP_EVENTS
+
+  DISALLOW_COPY_AND_ASSIGN(Engine);
+};
+
+}  // namespace midipal
+
+#endif  // MIDIPAL_ENGINE_H_
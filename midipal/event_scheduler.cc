@@ -32,75 +32,233 @@ EventScheduler::Entry EventScheduler::entries_[numEntries];
 /* static */
 uint8_t EventScheduler::root_ptr_;
 
+/* static */
+uint8_t EventScheduler::free_ptr_;
+
+#ifndef POLY_SEQUENCER_FIRMWARE
+
+/* static */
+uint8_t EventScheduler::pending_notes_[16];
+
+#endif  // POLY_SEQUENCER_FIRMWARE
+
+#ifdef USE_TIMING_WHEEL_SCHEDULER
+
+/* static */
+uint8_t EventScheduler::bucket_head_[kNumBuckets];
+
+/* static */
+uint8_t EventScheduler::bucket_tail_[kNumBuckets];
+
+/* static */
+uint8_t EventScheduler::position_;
+
+#endif  // USE_TIMING_WHEEL_SCHEDULER
+
 /* static */
 void EventScheduler::Init() {
   memset(entries_, kFreeSlot, numEntries * sizeof(Entry));
+  // The first entry is a dummy node, the others are chained in the free list.
+  for (uint8_t i = 1; i < numEntries - 1; ++i) {
+    entries_[i].next = i + 1;
+  }
+  entries_[numEntries - 1].next = 0;
+  free_ptr_ = 1;
   root_ptr_ = 0;
   size_ = 0;
+  ClearPending();
+#ifdef USE_TIMING_WHEEL_SCHEDULER
+  memset(bucket_head_, 0, sizeof(bucket_head_));
+  memset(bucket_tail_, 0, sizeof(bucket_tail_));
+  position_ = 0;
+#endif  // USE_TIMING_WHEEL_SCHEDULER
+}
+
+#ifndef POLY_SEQUENCER_FIRMWARE
+
+/* static */
+void EventScheduler::ClearPending() {
+  memset(pending_notes_, 0, sizeof(pending_notes_));
+}
+
+#endif  // POLY_SEQUENCER_FIRMWARE
+
+/* static */
+void EventScheduler::Insert(uint8_t& root, uint8_t address, uint8_t when) {
+  if (!root || when < entries_[root].when) {
+    if (root) {
+      entries_[root].when -= when;
+    }
+    entries_[address].when = when;
+    entries_[address].next = root;
+    root = address;
+  } else {
+    uint8_t insert_position = root;
+    when -= entries_[root].when;
+    uint8_t next = entries_[insert_position].next;
+    while (next && when >= entries_[next].when) {
+      when -= entries_[next].when;
+      insert_position = next;
+      next = entries_[insert_position].next;
+    }
+    if (next) {
+      entries_[next].when -= when;
+    }
+    entries_[address].when = when;
+    entries_[address].next = next;
+    entries_[insert_position].next = address;
+  }
+}
+
+/* static */
+uint8_t EventScheduler::Unlink(
+    uint8_t& root, uint8_t note, uint8_t velocity,
+    uint8_t& found, uint8_t& kept) {
+  uint8_t previous = 0;
+  uint8_t current = root;
+  while (current) {
+    uint8_t next = entries_[current].next;
+    if (!entries_[current].status &&
+        entries_[current].note == note &&
+        entries_[current].velocity == velocity) {
+      // The next entry inherits the delay of the removed one, so that it is
+      // still due at the same tick.
+      if (next) {
+        entries_[next].when += entries_[current].when;
+      }
+      if (previous) {
+        entries_[previous].next = next;
+      } else {
+        root = next;
+      }
+      Release(current);
+      ++found;
+    } else {
+      if (!entries_[current].status && entries_[current].note == note) {
+        ++kept;
+      }
+      previous = current;
+    }
+    current = next;
+  }
+  return previous;
+}
+
+#ifdef USE_TIMING_WHEEL_SCHEDULER
+
+/* static */
+void EventScheduler::Append(uint8_t address, uint8_t when) {
+  uint8_t bucket = (position_ + when) & (kNumBuckets - 1);
+  entries_[address].when = 0;
+  entries_[address].next = 0;
+  if (bucket_head_[bucket]) {
+    entries_[bucket_tail_[bucket]].next = address;
+  } else {
+    bucket_head_[bucket] = address;
+  }
+  bucket_tail_[bucket] = address;
 }
 
+/* static */
+void EventScheduler::Tick() {
+  uint8_t current = bucket_head_[position_];
+  while (current) {
+    uint8_t next = entries_[current].next;
+    Release(current);
+    current = next;
+  }
+  bucket_head_[position_] = 0;
+  position_ = (position_ + 1) & (kNumBuckets - 1);
+  if (!size_) {
+    ClearPending();
+  }
+
+  // Move the far events which are now within reach of the wheel. This happens
+  // before anything else can be scheduled for the same tick, so the order in
+  // which the events have been scheduled is preserved.
+  if (root_ptr_) {
+    --entries_[root_ptr_].when;
+    while (root_ptr_ && entries_[root_ptr_].when < kNumBuckets) {
+      uint8_t address = root_ptr_;
+      uint8_t when = entries_[address].when;
+      root_ptr_ = entries_[address].next;
+      if (root_ptr_) {
+        entries_[root_ptr_].when += when;
+      }
+      Append(address, when);
+    }
+  }
+}
+
+#else
+
 /* static */
 void EventScheduler::Tick() {
   while (!entries_[root_ptr_].when && root_ptr_) {
-    entries_[root_ptr_].note = kFreeSlot;
+    uint8_t expired = root_ptr_;
     root_ptr_ = entries_[root_ptr_].next;
-    --size_;
+    Release(expired);
+  }
+  if (!size_) {
+    ClearPending();
   }
   
-  uint8_t current = root_ptr_;
-  while (current) {
-    --entries_[current].when;
-    current = entries_[current].next;
+  // Since delays are relative to the previous entry, moving the root closer
+  // moves every other entry closer too.
+  if (root_ptr_) {
+    --entries_[root_ptr_].when;
   }
 }
 
+#endif  // USE_TIMING_WHEEL_SCHEDULER
+
 /* static */
 uint8_t EventScheduler::Remove(uint8_t note, uint8_t velocity) {
-  uint8_t current = root_ptr_;
+  if (!pending(note)) {
+    return 0;
+  }
   uint8_t found = 0;
-  while (current) {
-    if (entries_[current].note == note &&
-        entries_[current].velocity == velocity) {
-          entries_[current].note = kZombieSlot;
-      ++found;
+  uint8_t kept = 0;
+#ifdef USE_TIMING_WHEEL_SCHEDULER
+  for (uint8_t i = 0; i < kNumBuckets; ++i) {
+    if (bucket_head_[i]) {
+      bucket_tail_[i] = Unlink(bucket_head_[i], note, velocity, found, kept);
     }
-    current = entries_[current].next;
+  }
+#endif  // USE_TIMING_WHEEL_SCHEDULER
+  Unlink(root_ptr_, note, velocity, found, kept);
+  if (!kept) {
+    clear_pending(note);
   }
   return found;
 }
 
 /* static */
-void EventScheduler::Schedule(uint8_t note, uint8_t velocity, uint8_t when, uint8_t tag) {
-  // Locate a free entry in the list.
-  uint8_t free_slot = 0;
-  for (uint8_t i = 1; i < numEntries; ++i) {
-    if (entries_[i].note == kFreeSlot) {
-      free_slot = i;
-      break;
-    }
-  }
-  
+void EventScheduler::Enqueue(
+    uint8_t status, uint8_t data_1, uint8_t data_2, uint8_t when,
+    uint8_t tag) {
+  // Take the first entry from the free list.
+  uint8_t free_slot = free_ptr_;
   if (!free_slot) {
     return;  // Queue is full!
   }
+  free_ptr_ = entries_[free_slot].next;
   ++size_;
-  entries_[free_slot].note = note;
-  entries_[free_slot].velocity = velocity;
-  entries_[free_slot].when = when;
+  entries_[free_slot].note = data_1;
+  entries_[free_slot].velocity = data_2;
   entries_[free_slot].tag = tag;
+  entries_[free_slot].status = status;
+  if (!status) {
+    set_pending(data_1);
+  }
   
-  if (!root_ptr_ || when < entries_[root_ptr_].when) {
-    entries_[free_slot].next = root_ptr_;
-    root_ptr_ = free_slot;
-  } else {
-    uint8_t insert_position = root_ptr_;
-    while (entries_[insert_position].next &&
-           when >= entries_[entries_[insert_position].next].when) {
-      insert_position = entries_[insert_position].next;
-    }
-    entries_[free_slot].next = entries_[insert_position].next;
-    entries_[insert_position].next = free_slot;
+#ifdef USE_TIMING_WHEEL_SCHEDULER
+  if (when < kNumBuckets) {
+    Append(free_slot, when);
+    return;
   }
+#endif  // USE_TIMING_WHEEL_SCHEDULER
+  Insert(root_ptr_, free_slot, when);
 }
 
 }  // namespace midipal
@@ -17,6 +17,32 @@
 //
 // Event list. I apologize for not using a smarter data structure - the
 // insertion of an item in the queue is O(n) while it should be O(log n).
+//
+// The delay of each entry is stored relative to the previous entry in the
+// list (the root stores its delay relative to the current tick), so a tick
+// only has to decrement the root entry rather than walking the whole list.
+// Entries due at the current tick are the leading entries with a zero delay.
+//
+// Unused entries are chained through their next field into a free list, so
+// finding a slot for a new event does not require a scan.
+//
+// A bitmap records which notes may have pending events. Removing a note which
+// has nothing scheduled - by far the most frequent case with the arpeggiator -
+// thus does not walk the queue at all. Bits are set when an event is scheduled
+// and cleared when a removal finds no entry left for the note or when the
+// queue runs empty, so they can stay set for a while after the events have
+// been sent, but they are never missing for a note which has pending events.
+//
+// Besides notes, which are sent on the channel passed to the function draining
+// the queue, an entry can hold any channel message, with its status byte and
+// up to two data bytes. Only note entries can be cancelled with Remove().
+//
+// When USE_TIMING_WHEEL_SCHEDULER is defined, events due in less than
+// kNumBuckets ticks are instead appended to the bucket of a timing wheel, and
+// only events further in the future go through the sorted list above. The
+// root is then the head of the bucket for the current tick, whose entries all
+// have a zero delay - so the entries can be walked in the same way with both
+// implementations.
 
 #ifndef MIDIPAL_EVENT_SCHEDULER_H_
 #define MIDIPAL_EVENT_SCHEDULER_H_
@@ -34,35 +60,96 @@ class EventScheduler {
 #endif  // POLY_SEQUENCER_FIRMWARE
 
   static constexpr uint8_t kFreeSlot = 0xff;
-  static constexpr uint8_t kZombieSlot = 0xfe;
-
+#ifdef USE_TIMING_WHEEL_SCHEDULER
+  static constexpr uint8_t kNumBuckets = 64;
+#endif  // USE_TIMING_WHEEL_SCHEDULER
 
   struct Entry {
-    uint8_t note;  // 0xff for free slot
-    uint8_t velocity;  // 0 for note off
-    uint8_t when;
-    uint8_t next;
+    uint8_t note;  // 0xff for free slot. First data byte for a message.
+    uint8_t velocity;  // 0 for note off. Second data byte for a message.
+    uint8_t when;  // In ticks, relative to the previous entry.
+    uint8_t next;  // Next free entry when the slot is free.
     uint8_t tag;
+    uint8_t status;  // 0 for a note, status byte for a channel message.
   };
 
   static void Init();
   static void Tick();
-  static void Schedule(uint8_t note, uint8_t velocity, uint8_t when, uint8_t tag = 0);
+  static void Schedule(uint8_t note, uint8_t velocity, uint8_t when, uint8_t tag = 0) {
+    Enqueue(0, note, velocity, when, tag);
+  }
+  static void ScheduleMessage(
+      uint8_t status, uint8_t data_1, uint8_t data_2, uint8_t when) {
+    Enqueue(status, data_1, data_2, when, 0);
+  }
   static uint8_t Remove(uint8_t note, uint8_t velocity);
   
   static const Entry& entryAt(uint8_t address) {
     return entries_[address];
   }
+#ifdef USE_TIMING_WHEEL_SCHEDULER
+  static uint8_t root() { return bucket_head_[position_]; }
+#else
   static uint8_t root() { return root_ptr_; }
+#endif  // USE_TIMING_WHEEL_SCHEDULER
   static uint8_t size() { return size_; }
   static bool overflow() {
     return size() >= numEntries - 8;
   }
 
  private:
+  static void Release(uint8_t address) {
+    entries_[address].note = kFreeSlot;
+    entries_[address].next = free_ptr_;
+    free_ptr_ = address;
+    --size_;
+  }
+  static void Enqueue(
+      uint8_t status, uint8_t data_1, uint8_t data_2, uint8_t when,
+      uint8_t tag);
+  static void Insert(uint8_t& root, uint8_t address, uint8_t when);
+  static uint8_t Unlink(
+      uint8_t& root, uint8_t note, uint8_t velocity,
+      uint8_t& found, uint8_t& kept);
+#ifdef POLY_SEQUENCER_FIRMWARE
+  // With 4 entries, scanning the queue is cheaper than 16 bytes of bitmap.
+  static bool pending(uint8_t) { return true; }
+  static void set_pending(uint8_t) { }
+  static void clear_pending(uint8_t) { }
+  static void ClearPending() { }
+#else
+  static bool pending(uint8_t note) {
+    return pending_byte(note) & pending_mask(note);
+  }
+  static void set_pending(uint8_t note) {
+    pending_byte(note) |= pending_mask(note);
+  }
+  static void clear_pending(uint8_t note) {
+    pending_byte(note) &= ~pending_mask(note);
+  }
+  static void ClearPending();
+  static uint8_t& pending_byte(uint8_t note) {
+    return pending_notes_[(note >> 3) & 0xf];
+  }
+  static uint8_t pending_mask(uint8_t note) {
+    return 1 << (note & 0x7);
+  }
+#endif  // POLY_SEQUENCER_FIRMWARE
+
   static Entry entries_[EventScheduler::numEntries];
-  static uint8_t root_ptr_;
+  static uint8_t root_ptr_;  // With the timing wheel: events beyond it.
+  static uint8_t free_ptr_;
   static uint8_t size_;
+#ifndef POLY_SEQUENCER_FIRMWARE
+  static uint8_t pending_notes_[16];
+#endif  // POLY_SEQUENCER_FIRMWARE
+#ifdef USE_TIMING_WHEEL_SCHEDULER
+  static void Append(uint8_t address, uint8_t when);
+
+  static uint8_t bucket_head_[kNumBuckets];
+  static uint8_t bucket_tail_[kNumBuckets];
+  static uint8_t position_;
+#endif  // USE_TIMING_WHEEL_SCHEDULER
   
   DISALLOW_COPY_AND_ASSIGN(EventScheduler);
 };
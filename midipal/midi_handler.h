@@ -22,10 +22,14 @@
 
 #include "midi/midi.h"
 #include "midipal/app.h"
+#include "midipal/app_registry.h"
+#include "midipal/profiler.h"
 #include "midipal/sysex_handler.h"
 
 namespace midipal {
 
+// The time spent in the app handlers is measured by the profiler, when
+// enabled.
 struct MidiHandler : public midi::MidiDevice {
 
   enum {
@@ -36,77 +40,128 @@ struct MidiHandler : public midi::MidiDevice {
   typedef avrlib::DataTypeForSize<data_size>::Type Value;
 
   static void NoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
+    uint16_t start = Profiler::now();
     App::OnNoteOn(channel, note, velocity);
+    Profiler::AddAppTime(start);
   }
 
   static void NoteOff(uint8_t channel, uint8_t note, uint8_t velocity) {
+    uint16_t start = Profiler::now();
     App::OnNoteOff(channel, note, velocity);
+    Profiler::AddAppTime(start);
   }
 
   static void Aftertouch(uint8_t channel, uint8_t note, uint8_t velocity) {
+    uint16_t start = Profiler::now();
     App::OnAftertouch(channel, note, velocity);
+    Profiler::AddAppTime(start);
   }
 
   static void Aftertouch(uint8_t channel, uint8_t velocity) {
+    uint16_t start = Profiler::now();
     App::OnAftertouch(channel, velocity);
+    Profiler::AddAppTime(start);
   }
 
   static void ControlChange(uint8_t channel, uint8_t controller,
                              uint8_t value) {
+    uint16_t start = Profiler::now();
     App::OnControlChange(channel, controller, value);
+    Profiler::AddAppTime(start);
   }
 
   static void ProgramChange(uint8_t channel, uint8_t program) {
+    uint16_t start = Profiler::now();
     App::OnProgramChange(channel, program);
+    Profiler::AddAppTime(start);
   }
 
   static void PitchBend(uint8_t channel, uint16_t pitch_bend) {
+    uint16_t start = Profiler::now();
     App::OnPitchBend(channel, pitch_bend);
+    Profiler::AddAppTime(start);
   }
 
   static void SysExStart() {
+    uint16_t start = Profiler::now();
     App::OnSysExByte(0xf0);
+    Profiler::AddAppTime(start);
     sysex_handler.Receive(0xf0);
   }
 
   static void SysExByte(uint8_t sysex_byte) {
+    uint16_t start = Profiler::now();
     App::OnSysExByte(sysex_byte);
+    Profiler::AddAppTime(start);
     sysex_handler.Receive(sysex_byte);
   }
 
   static void SysExEnd() {
+    uint16_t start = Profiler::now();
     App::OnSysExByte(0xf7);
+    Profiler::AddAppTime(start);
     sysex_handler.Receive(0xf7);
   }
 
   static void BozoByte(uint8_t bozo_byte) { }
 
   static void Clock() {
+    uint16_t start = Profiler::now();
     App::OnClock(CLOCK_MODE_EXTERNAL);
+    Profiler::AddAppTime(start);
   }
 
   static void Start() {
+    uint16_t start = Profiler::now();
     App::OnStart();
+    Profiler::AddAppTime(start);
   }
 
   static void Continue() {
+    uint16_t start = Profiler::now();
     App::OnContinue();
+    Profiler::AddAppTime(start);
   }
 
   static void Stop() {
+    uint16_t start = Profiler::now();
     App::OnStop();
+    Profiler::AddAppTime(start);
+  }
+
+  static void SongPosition(uint16_t position) {
+    uint16_t start = Profiler::now();
+    App::OnSongPosition(position);
+    Profiler::AddAppTime(start);
+  }
+
+  static void QuarterFrame(uint8_t data) {
+    uint16_t start = Profiler::now();
+    App::OnQuarterFrame(data);
+    Profiler::AddAppTime(start);
   }
 
   static uint8_t CheckChannel(uint8_t channel) {
-    return App::CheckChannel(channel);
+    uint16_t start = Profiler::now();
+    uint8_t result = App::CheckChannel(channel);
+    Profiler::AddAppTime(start);
+    return result;
   }
 
+  // Most apps parse their input: only the ones forwarding it byte by byte
+  // pay for the call.
+  static uint8_t CheckRawByte() { return App::has_raw_byte_handler(); }
+
   static void RawByte(uint8_t byte) {
+    uint16_t start = Profiler::now();
     App::OnRawByte(byte);
+    Profiler::AddAppTime(start);
   }
 
   static void RawMidiData(uint8_t status, uint8_t* data, uint8_t data_size) {
+    uint16_t start = Profiler::now();
     App::OnRawMidiData(status, data, data_size);
+    Profiler::AddAppTime(start);
   }
 };
 
@@ -22,12 +22,15 @@
 
 #include "midi/midi.h"
 #include "midipal/app.h"
-#include "midipal/apps/settings.h"
 #include "midipal/clock.h"
+#include "midipal/engine.h"
 #include "midipal/event_scheduler.h"
-#include "midipal/midi_handler.h"
 #include "midipal/note_stack.h"
+#include "midipal/pipeline.h"
+#include "midipal/profiler.h"
 #include "midipal/resources.h"
+#include "midipal/settings_store.h"
+#include "midipal/stack_monitor.h"
 #include "midipal/ui.h"
 
 using namespace avrlib;
@@ -36,68 +39,99 @@ using namespace midipal;
 
 // Midi input.
 using MidiIo = Serial<MidiPort, 31250, POLLED, POLLED>;
-MidiStreamParser<MidiHandler> midi_parser;
 
-volatile uint8_t num_clock_ticks = 0;
-
-inline int freeRam() {
-  extern int __heap_start, *__brkval;
-  uint8_t v;
-  if (__brkval /* > 0 */) {
-    return (int)(&v) - (int)__brkval;
-  } else {
-    return (int)(&v) - (int)&__heap_start;
+// Must be called before reading the received byte the flags refer to.
+inline void CheckInputErrors() {
+  uint8_t status = UCSR0A;
+  if (status & bitFlag8(DOR0)) {
+    Engine::CountInputError(INPUT_ERROR_OVERRUN);
+  }
+  if (status & bitFlag8(FE0)) {
+    Engine::CountInputError(INPUT_ERROR_FRAMING);
   }
 }
 
+#ifdef ENABLE_MIDI_RX_ISR
+
+ISR(USART_RX_vect) {
+  CheckInputErrors();
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+  Engine::PostEvent(EVENT_INPUT_BYTE, UDR0);
+#else
+  Engine::BufferInputByte(UDR0);
+#endif  // ENABLE_MAIN_LOOP_EVENTS
+}
+
+#endif  // ENABLE_MIDI_RX_ISR
+
 ISR(TIMER2_OVF_vect, ISR_NOBLOCK) {
   static uint8_t sub_clock;
+  uint16_t start = Profiler::now();
+  uint16_t app_start = Profiler::app_time();
 
+#if defined(ENABLE_MAIN_LOOP_EVENTS)
+#ifndef ENABLE_MIDI_RX_ISR
   if (MidiIo::readable()) {
+    CheckInputErrors();
+    Engine::PostEvent(EVENT_INPUT_BYTE, MidiIo::ImmediateRead());
+    Profiler::RecordInput(start, app_start);
+  }
+#endif  // ENABLE_MIDI_RX_ISR
+#elif defined(ENABLE_MIDI_RX_ISR)
+  if (MidiInput::Buffer::readable()) {
+    if (Engine::ProcessInputBuffer()) {
+      LedIn::High();
+    }
+    Profiler::RecordInput(start, app_start);
+  }
+#else
+  if (MidiIo::readable()) {
+    CheckInputErrors();
     uint8_t byte = MidiIo::ImmediateRead();
-    if (byte != 0xfe || !apps::Settings::filter_active_sensing()) {
+    if (Engine::PushInputByte(byte)) {
       LedIn::High();
-      midi_parser.PushByte(byte);
     }
+    Profiler::RecordInput(start, app_start);
   }
+#endif  // ENABLE_MIDI_RX_ISR
   
   // 4kHz
-  if (MidiHandler::OutputBuffer::readable() && MidiIo::writable()) {
-    LedOut::High();
-    MidiIo::Overwrite(MidiHandler::OutputBuffer::ImmediateRead());
-  }
-  
-  while (num_clock_ticks) {
-    --num_clock_ticks;
-    App::OnClock(CLOCK_MODE_INTERNAL);
-  }
+  App::TransmitOutputByte();
+#ifndef ENABLE_MAIN_LOOP_EVENTS
+  App::FlushPendingMessage();
+
+  // With the main loop events, deferred clock ticks are queued as events.
+  uint16_t clock_start = Profiler::now();
+  Engine::ProcessClockTicks();
+  Profiler::Record(PROFILER_SECTION_CLOCK, clock_start);
+#endif  // ENABLE_MAIN_LOOP_EVENTS
 
-  if (freeRam() <= 10) {
-    LedIn::High();
-    LedOut::High();
-  }
-  
   sub_clock = byteAnd(sub_clock + 1, 3);
   if (byteAnd(sub_clock, 1) == 0) {
     // 2kHz
+    uint16_t t = Profiler::now();
     Ui::Poll();
     if (byteAnd(sub_clock, 3) == 0) {
       TickSystemClock();
       LedOut::Low();
       LedIn::Low();
     }
+    Profiler::Record(PROFILER_SECTION_UI, t);
   }
+  Profiler::Record(PROFILER_SECTION_TIMER2, start);
+}
+
+#ifdef ENABLE_ISR_PROFILER
+ISR(TIMER0_OVF_vect) {
+  Profiler::Overflow();
 }
+#endif  // ENABLE_ISR_PROFILER
 
 ISR(TIMER1_COMPA_vect, ISR_BLOCK) {
+  uint16_t start = Profiler::now();
   PwmChannel1A::set_frequency(Clock::Tick());
-  if (Clock::running()) {
-    if (App::realtime_clock_handling()) {
-      App::OnClock(CLOCK_MODE_INTERNAL);
-    } else {
-      ++num_clock_ticks;
-    }
-  }
+  Engine::OnInternalClockTick();
+  Profiler::Record(PROFILER_SECTION_TIMER1, start);
 }
 
 void Init() {
@@ -107,7 +141,9 @@ void Init() {
   LedOut::set_mode(DIGITAL_OUTPUT);
   LedIn::set_mode(DIGITAL_OUTPUT);
   
+  NotePool::Init();
   NoteStack::Init();
+  note_map().Clear();
   EventScheduler::Init();
   
   // Boot the settings app.
@@ -125,6 +161,9 @@ void Init() {
     launch_app = 0;
     App::SetParameter(0, launch_app);
   }
+#ifdef APP_PIPELINE
+  Pipeline::Init();
+#endif  // APP_PIPELINE
   App::Launch(launch_app);
   
   Ui::Init();
@@ -139,14 +178,30 @@ void Init() {
   Timer<2>::set_prescaler(2);
   Timer<2>::set_mode(TIMER_PWM_PHASE_CORRECT);
   Timer<2>::Start();
+  Profiler::Init();
   App::Init();
   MidiIo::Init();
+#ifdef ENABLE_MIDI_RX_ISR
+  UCSR0B |= bitFlag8(RXCIE0);
+#endif  // ENABLE_MIDI_RX_ISR
 }
 
 int main() {
+  StackMonitor::Init();
   ResetWatchdog();
   Init();
   while (true) {
+    StackMonitor::Scan();
+    if (StackMonitor::min_free() <= 10) {
+      LedIn::High();
+      LedOut::High();
+    }
+#ifdef ENABLE_MAIN_LOOP_EVENTS
+    if (Engine::ProcessEvents()) {
+      LedIn::High();
+    }
+#endif  // ENABLE_MAIN_LOOP_EVENTS
     Ui::DoEvents();
+    SettingsStore::Commit();
   }
 }
@@ -16,6 +16,11 @@
 // -----------------------------------------------------------------------------
 //
 // Map from a note index to an 8-bit integer.
+//
+// The storage is chosen by a policy: CompactNoteMapStorage is a small array
+// searched linearly, which has to evict an entry when full;
+// DirectNoteMapStorage is a table indexed by note, which costs 144 bytes but
+// never evicts anything.
 
 #ifndef MIDIPAL_NOTE_MAP_H_
 #define MIDIPAL_NOTE_MAP_H_
@@ -27,52 +32,113 @@
 namespace midipal {
 
 struct NoteMapEntry {
-  uint8_t note;
+  uint8_t note;  // 0xff if the entry is unused.
   uint8_t value;
 };
 
 template<uint8_t size>
-class NoteMap {
+class CompactNoteMapStorage {
  public:
-  NoteMap() {
-    memset(map_, 0xff, size * sizeof(NoteMapEntry));
+  void Clear() {
+    num_entries_ = 0;
   }
-  
-  void Put(uint8_t note, uint8_t value) {
-    uint8_t index = 0xff;
-    for (uint8_t i = 0; i < size; ++i) {
-      if (map_[i].note == note) {
-        index = i;
-        break;
-      }
-    }
+
+  // Returns the entry evicted to make room, whose note is 0xff if none was.
+  // The oldest entry is evicted first.
+  NoteMapEntry Put(uint8_t note, uint8_t value) {
+    NoteMapEntry evicted = { 0xff, 0 };
+    uint8_t index = IndexOf(note);
     if (index == 0xff) {
-      for (uint8_t i = 0; i < size; ++i) {
-        if (map_[i].note == 0xff) {
-          index = i;
-          break;
-        }
+      if (num_entries_ == size) {
+        evicted = map_[0];
+        RemoveAt(0);
       }
-    }
-    if (index == 0xff) {
-      index = 0;
+      index = num_entries_++;
     }
     map_[index].note = note;
     map_[index].value = value;
+    return evicted;
   }
-  
-  NoteMapEntry* Find(uint8_t note) {
-    for (uint8_t i = 0; i < size; ++i) {
+
+  bool Find(uint8_t note, uint8_t* value) const {
+    uint8_t index = IndexOf(note);
+    if (index == 0xff) {
+      return false;
+    }
+    *value = map_[index].value;
+    return true;
+  }
+
+  void Remove(uint8_t note) {
+    uint8_t index = IndexOf(note);
+    if (index != 0xff) {
+      RemoveAt(index);
+    }
+  }
+
+ private:
+  uint8_t IndexOf(uint8_t note) const {
+    for (uint8_t i = 0; i < num_entries_; ++i) {
       if (map_[i].note == note) {
-        return &map_[i];
+        return i;
       }
     }
-    return nullptr;
+    return 0xff;
+  }
+
+  // Entries are kept in insertion order.
+  void RemoveAt(uint8_t index) {
+    --num_entries_;
+    for (uint8_t i = index; i < num_entries_; ++i) {
+      map_[i] = map_[i + 1];
+    }
   }
 
- private:
   NoteMapEntry map_[size];
-  
+  uint8_t num_entries_;
+};
+
+class DirectNoteMapStorage {
+ public:
+  void Clear() {
+    memset(used_, 0, sizeof(used_));
+  }
+
+  NoteMapEntry Put(uint8_t note, uint8_t value) {
+    note = U7(note);
+    used_[note >> 3] |= 1 << (note & 7);
+    value_[note] = value;
+    NoteMapEntry evicted = { 0xff, 0 };
+    return evicted;
+  }
+
+  bool Find(uint8_t note, uint8_t* value) const {
+    note = U7(note);
+    if (!(used_[note >> 3] & (1 << (note & 7)))) {
+      return false;
+    }
+    *value = value_[note];
+    return true;
+  }
+
+  void Remove(uint8_t note) {
+    note = U7(note);
+    used_[note >> 3] &= ~(1 << (note & 7));
+  }
+
+ private:
+  uint8_t value_[128];
+  uint8_t used_[128 / 8];
+};
+
+template<typename Storage>
+class NoteMap : public Storage {
+ public:
+  NoteMap() {
+    Storage::Clear();
+  }
+
+ private:
   DISALLOW_COPY_AND_ASSIGN(NoteMap);
 };
 
@@ -24,96 +24,51 @@
 namespace midipal {
 
 /* static */
-uint8_t NoteStack::size_;
-
-/* static */
-NoteEntry NoteStack::pool_[kNoteStackSize + 1];
-
-/* static */
-uint8_t NoteStack::root_ptr_;
-
-/* static */
-uint8_t NoteStack::sorted_ptr_[kNoteStackSize + 1];
-
-/* static */
-void NoteStack::NoteOn(uint8_t note, uint8_t velocity) {
-  // Remove the note from the list first (in case it is already here).
-  NoteOff(note);
-  // In case of saturation, remove the least recently played note from the
-  // stack.
-  if (size_ == kNoteStackSize) {
-    NoteOff(least_recent_note().note);
-  }
-
-  // Now we are ready to insert the new note. Find a free slot to insert it.
-  uint8_t free_slot = 0; // TODO is initializing to zero valid?
-  for (uint8_t i = 1; i <= kNoteStackSize; ++i) {
-    if (pool_[i].note == kFreeSlot) {
-      free_slot = i;
-    }
-  }
-  pool_[free_slot].next_ptr = root_ptr_;
-  pool_[free_slot].note = note;
-  pool_[free_slot].velocity = velocity;
-  root_ptr_ = free_slot;
-  // The last step consists in inserting the note in the sorted list.
-  for (uint8_t i = 0; i < size_; ++i) {
-    if (pool_[sorted_ptr_[i]].note > note) {
-      for (uint8_t j = size_; j > i; --j) {
-        sorted_ptr_[j] = sorted_ptr_[j - 1];
-      }
-      sorted_ptr_[i] = free_slot;
-      free_slot = 0;
-      break;
-    }
+void NotePool::Init() {
+  Tables& t = tables();
+  memset(t.pool, 0, sizeof(t.pool));
+  memset(t.owner, 0, sizeof(t.owner));
+  memset(t.alias_ptr, 0, sizeof(t.alias_ptr));
+  memset(t.bucket, 0, sizeof(t.bucket));
+  for (uint8_t i = 0; i <= kNotePoolSize; ++i) {
+    t.pool[i].note = kFreeSlot;
   }
-  if (free_slot) {
-    sorted_ptr_[size_] = free_slot;
+  // Chain all the nodes but the dummy one in the free list.
+  for (uint8_t i = 1; i < kNotePoolSize; ++i) {
+    t.pool[i].next_ptr = i + 1;
   }
-  ++size_;
+  t.free_ptr = 1;
 }
 
 /* static */
-void NoteStack::NoteOff(uint8_t note) {
-  uint8_t current = root_ptr_;
-  uint8_t previous = 0;
-  while (current) {
-    if (pool_[current].note == note) {
-      break;
-    }
-    previous = current;
-    current = pool_[current].next_ptr;
-  }
-  if (current) {
-    if (previous) {
-      pool_[previous].next_ptr = pool_[current].next_ptr;
-    } else {
-      root_ptr_ = pool_[current].next_ptr;
-    }
-    for (uint8_t i = 0; i < size_; ++i) {
-      if (sorted_ptr_[i] == current) {
-        for (uint8_t j = i; j < size_ - 1; ++j) {
-          sorted_ptr_[j] = sorted_ptr_[j + 1];
-        }
-        break;
-      }
-    }
-    pool_[current].next_ptr = 0;
-    pool_[current].note = kFreeSlot;
-    pool_[current].velocity = 0;
-    --size_;
+uint8_t NotePool::Allocate(uint8_t owner, uint8_t note) {
+  Tables& t = tables();
+  uint8_t slot = t.free_ptr;
+  if (slot) {
+    t.free_ptr = t.pool[slot].next_ptr;
+    t.pool[slot].note = note;
+    t.owner[slot] = owner;
+    t.alias_ptr[slot] = t.bucket[bucket(note)];
+    t.bucket[bucket(note)] = slot;
   }
+  return slot;
 }
 
 /* static */
-void NoteStack::Clear() {
-  size_ = 0;
-  memset(pool_ + 1, 0, sizeof(NoteEntry) * kNoteStackSize);
-  memset(sorted_ptr_ + 1, 0, kNoteStackSize);
-  root_ptr_ = 0;
-  for (uint8_t i = 0; i <= kNoteStackSize; ++i) {
-    pool_[i].note = kFreeSlot;
+void NotePool::Release(uint8_t slot) {
+  Tables& t = tables();
+  uint8_t* link = &t.bucket[bucket(t.pool[slot].note)];
+  while (*link != slot) {
+    link = &t.alias_ptr[*link];
   }
+  *link = t.alias_ptr[slot];
+  t.alias_ptr[slot] = 0;
+  t.owner[slot] = 0;
+  t.pool[slot].note = kFreeSlot;
+  t.pool[slot].velocity = 0;
+  t.pool[slot].prev_ptr = 0;
+  t.pool[slot].next_ptr = t.free_ptr;
+  t.free_ptr = slot;
 }
 
 }  // namespace midipal
@@ -26,17 +26,20 @@
 // player releases C5 -> G4 is played.
 // player releases G4 -> C4 is played.
 //
-// The nodes used in the linked list are pre-allocated from a pool of 16
-// nodes, so the "pointers" (to the root element for example) are not actual
-// pointers, but indices of an element in the pool.
+// The nodes used in the linked list are pre-allocated from a pool shared by
+// all the stacks, so the "pointers" (to the root element for example) are
+// not actual pointers, but indices of an element in the pool. The list is
+// doubly linked, unused nodes are chained in a free list, and the pool keeps
+// the nodes in use in a small hash table keyed by note, so that adding or
+// removing a note does not require walking the list.
 //
-// Additionally, an array of pointers is stored to allow random access to the
-// n-th note, sorted by ascending order of pitch (for arpeggiation).
+// Additionally, two arrays of pointers are stored to allow random access to
+// the n-th note, sorted by ascending order of pitch or by order of arrival
+// (for arpeggiation).
 //
-// TODO(pichenettes): having this class implemented as a "static singleton"
-// saves almost 300 bytes of code. w00t! But we'd rather move this back to a
-// simple class when adding multitimbrality. When will we add multitimbrality?
-// Probably never.
+// Apps handling several channels can have one PooledNoteStack per channel.
+// NoteStack is the static singleton used by the single-channel apps - having
+// it "static" saves code size, and its methods are inlined forwarders.
 
 #ifndef MIDIPAL_NOTE_STACK_H_
 #define MIDIPAL_NOTE_STACK_H_
@@ -44,6 +47,7 @@
 #include "avrlib/base.h"
 #include "avrlib/op.h"
 
+#include "midipal/notes.h"
 
 namespace midipal {
 
@@ -51,52 +55,244 @@ struct NoteEntry {
   uint8_t note;
   uint8_t velocity;
   uint8_t next_ptr;  // Base 1.
+  uint8_t prev_ptr;  // Base 1.
 };
 
-class NoteStack {
+// Enough for a full 16-note stack, with a few nodes left for the other stacks
+// of a pipeline firmware. The other firmwares only have NoteStack.
+#ifdef APP_PIPELINE
+static constexpr uint8_t kNotePoolSize = 24;
+#else
+static constexpr uint8_t kNotePoolSize = 16;
+#endif  // APP_PIPELINE
+
+// Held notes are found through a hash table keyed by the note number, its
+// chains running through the pool. With at most kNotePoolSize nodes, chains
+// are 2 nodes long on average, for an eighth of the RAM of a table indexed by
+// note.
+static constexpr uint8_t kNumNoteBuckets = 16;
+
+// In the app arena, past the note map, which the scale processor uses too.
+static const uint16_t kNotePoolArenaOffset = kNoteMapArenaEnd;
+
+class NotePool {
+ public:
   static constexpr uint8_t kFreeSlot = 0xff;
-  static constexpr uint8_t kNoteStackSize = 16;
 
+  static void Init();
+  // Returns a new owner id, to be used by a stack for all its calls.
+  static uint8_t NewOwner() { return ++tables().num_owners; }
+
+  // Returns a node holding note for owner, or 0 if the pool is exhausted.
+  static uint8_t Allocate(uint8_t owner, uint8_t note);
+  static void Release(uint8_t slot);
+  // Returns the node holding note for owner, or 0.
+  static uint8_t Find(uint8_t owner, uint8_t note) {
+    Tables& t = tables();
+    note = U7(note);
+    uint8_t slot = t.bucket[bucket(note)];
+    while (slot && (t.owner[slot] != owner || t.pool[slot].note != note)) {
+      slot = t.alias_ptr[slot];
+    }
+    return slot;
+  }
+
+  static NoteEntry& entry(uint8_t slot) { return tables().pool[slot]; }
+
+  struct Tables {
+    NoteEntry pool[kNotePoolSize + 1];  // First element is a dummy node!
+    uint8_t owner[kNotePoolSize + 1];
+    // Next node in the same bucket. Base 1.
+    uint8_t alias_ptr[kNotePoolSize + 1];
+    // First node holding a note of each bucket. Base 1, 0 if none is held.
+    uint8_t bucket[kNumNoteBuckets];
+    uint8_t free_ptr;  // Base 1.
+    uint8_t num_owners;
+  };
+
+ private:
+  static Tables& tables() {
+    return ArenaObject<Tables, kNotePoolArenaOffset>::get();
+  }
+  static uint8_t bucket(uint8_t note) {
+    return byteAnd(note, kNumNoteBuckets - 1);
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(NotePool);
+};
+
+template<uint8_t capacity>
+class PooledNoteStack {
  public:
-  static void Init() { Clear(); }
+  // NotePool::Init() must have been called first.
+  void Init() {
+    if (!owner_) {
+      owner_ = NotePool::NewOwner();
+    }
+    Clear();
+  }
 
-  static void NoteOn(uint8_t note, uint8_t velocity);
-  static void NoteOff(uint8_t note);
-  static void Clear();
+  void NoteOn(uint8_t note, uint8_t velocity) {
+    note = U7(note);
+    // Remove the note from the list first (in case it is already here).
+    uint8_t free_slot = NotePool::Find(owner_, note);
+    if (free_slot) {
+      Remove(free_slot);
+    }
+    // In case of saturation, remove the least recently played note from the
+    // stack.
+    if (size_ == capacity) {
+      Remove(tail_ptr_);
+    }
+    free_slot = NotePool::Allocate(owner_, note);
+    if (!free_slot) {
+      // The pool is shared with other stacks: make room in this one.
+      if (!size_) {
+        return;
+      }
+      Remove(tail_ptr_);
+      free_slot = NotePool::Allocate(owner_, note);
+    }
 
-  static uint8_t size() { return size_; }
-  static const NoteEntry& most_recent_note() { return pool_[root_ptr_]; }
-  static const NoteEntry& least_recent_note() {
-    uint8_t current = root_ptr_;
-    while (current && pool_[current].next_ptr) {
-      current = pool_[current].next_ptr;
+    // Now we are ready to insert the new note at the head of the list.
+    NoteEntry& entry = NotePool::entry(free_slot);
+    entry.next_ptr = root_ptr_;
+    entry.prev_ptr = 0;
+    entry.velocity = velocity;
+    if (root_ptr_) {
+      NotePool::entry(root_ptr_).prev_ptr = free_slot;
+    } else {
+      tail_ptr_ = free_slot;
+    }
+    root_ptr_ = free_slot;
+    played_ptr_[size_] = free_slot;
+    // The last step consists in inserting the note in the sorted list.
+    for (uint8_t i = 0; i < size_; ++i) {
+      if (NotePool::entry(sorted_ptr_[i]).note > note) {
+        for (uint8_t j = size_; j > i; --j) {
+          sorted_ptr_[j] = sorted_ptr_[j - 1];
+        }
+        sorted_ptr_[i] = free_slot;
+        free_slot = 0;
+        break;
+      }
     }
-    return pool_[current];
+    if (free_slot) {
+      sorted_ptr_[size_] = free_slot;
+    }
+    ++size_;
   }
-  static const NoteEntry& played_note(uint8_t index) {
-    uint8_t current = root_ptr_;
-    index = size_ - index - 1_u8;
-    for (uint8_t i = 0; i < index; ++i) {
-      current = pool_[current].next_ptr;
+
+  void NoteOff(uint8_t note) {
+    uint8_t current = NotePool::Find(owner_, note);
+    if (current) {
+      Remove(current);
     }
-    return pool_[current];
   }
-  static const NoteEntry& sorted_note(uint8_t index) {
-    return pool_[sorted_ptr_[index]];
+
+  void Clear() {
+    while (root_ptr_) {
+      Remove(root_ptr_);
+    }
+  }
+
+  uint8_t size() const { return size_; }
+  const NoteEntry& most_recent_note() const {
+    return NotePool::entry(root_ptr_);
+  }
+  const NoteEntry& least_recent_note() const {
+    return NotePool::entry(tail_ptr_);
+  }
+  const NoteEntry& played_note(uint8_t index) const {
+    return NotePool::entry(played_ptr_[index]);
+  }
+  const NoteEntry& sorted_note(uint8_t index) const {
+    return NotePool::entry(sorted_ptr_[index]);
   }
-  static const NoteEntry& note(uint8_t index) { return pool_[index]; }
-  static const NoteEntry& dummy() { return pool_[0]; }
 
  private:
-  static uint8_t size_;
-  static NoteEntry pool_[kNoteStackSize + 1];  // First element is a dummy node!
-  static uint8_t root_ptr_;  // Base 1.
-  static uint8_t sorted_ptr_[kNoteStackSize + 1];  // Base 1.
+  void Remove(uint8_t slot) {
+    NoteEntry& entry = NotePool::entry(slot);
+    if (entry.prev_ptr) {
+      NotePool::entry(entry.prev_ptr).next_ptr = entry.next_ptr;
+    } else {
+      root_ptr_ = entry.next_ptr;
+    }
+    if (entry.next_ptr) {
+      NotePool::entry(entry.next_ptr).prev_ptr = entry.prev_ptr;
+    } else {
+      tail_ptr_ = entry.prev_ptr;
+    }
+    RemoveFromIndex(sorted_ptr_, slot);
+    RemoveFromIndex(played_ptr_, slot);
+    NotePool::Release(slot);
+    --size_;
+  }
 
-  DISALLOW_COPY_AND_ASSIGN(NoteStack);
+  void RemoveFromIndex(uint8_t* index, uint8_t slot) {
+    for (uint8_t i = 0; i < size_; ++i) {
+      if (index[i] == slot) {
+        for (uint8_t j = i; j < size_ - 1; ++j) {
+          index[j] = index[j + 1];
+        }
+        break;
+      }
+    }
+  }
+
+  uint8_t owner_;
+  uint8_t size_;
+  uint8_t root_ptr_;  // Base 1.
+  uint8_t tail_ptr_;  // Base 1.
+  uint8_t sorted_ptr_[capacity];  // Base 1.
+  uint8_t played_ptr_[capacity];  // Base 1, oldest first.
 };
 
-extern NoteStack note_stack;
+static constexpr uint8_t kNoteStackSize = 16;
+
+// In the app arena, after the pool.
+static const uint16_t kNoteStackArenaOffset =
+    kNotePoolArenaOffset + sizeof(NotePool::Tables);
+static const uint16_t kNoteStackArenaEnd =
+    kNoteStackArenaOffset + sizeof(PooledNoteStack<kNoteStackSize>);
+
+class NoteStack {
+ public:
+  static void Init() { stack().Init(); }
+
+  static void NoteOn(uint8_t note, uint8_t velocity) {
+    stack().NoteOn(note, velocity);
+  }
+  static void NoteOff(uint8_t note) { stack().NoteOff(note); }
+  static void Clear() { stack().Clear(); }
+
+  static uint8_t size() { return stack().size(); }
+  static const NoteEntry& most_recent_note() {
+    return stack().most_recent_note();
+  }
+  static const NoteEntry& least_recent_note() {
+    return stack().least_recent_note();
+  }
+  static const NoteEntry& played_note(uint8_t index) {
+    return stack().played_note(index);
+  }
+  static const NoteEntry& sorted_note(uint8_t index) {
+    return stack().sorted_note(index);
+  }
+  static const NoteEntry& note(uint8_t index) {
+    return NotePool::entry(index);
+  }
+  static const NoteEntry& dummy() { return NotePool::entry(0); }
+
+  // For the code written against a PooledNoteStack.
+  static PooledNoteStack<kNoteStackSize>& stack() {
+    return ArenaObject<
+        PooledNoteStack<kNoteStackSize>, kNoteStackArenaOffset>::get();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(NoteStack);
+};
 
 }  // namespace midipal
 
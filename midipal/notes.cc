@@ -75,7 +75,4 @@ uint8_t Constraint(uint8_t note, uint8_t root, uint8_t scale) {
   return note;
 }
 
-/* extern */
-NoteMap<kNoteMapSize> note_map;
-
 }  // namespace midipal
@@ -31,12 +31,21 @@ struct Note {
   uint8_t note;
 };
 
-#ifdef POLY_SEQUENCER_FIRMWARE
-static const uint8_t kNoteMapSize = 2;
+#if defined(POLY_SEQUENCER_FIRMWARE)
+typedef NoteMap<CompactNoteMapStorage<2> > GlobalNoteMap;
+#elif defined(USE_DIRECT_NOTE_MAP)
+// 79 more bytes of RAM, and the same lookup time for any number of notes.
+typedef NoteMap<DirectNoteMapStorage> GlobalNoteMap;
 #else
-static const uint8_t kNoteMapSize = 32;
+typedef NoteMap<CompactNoteMapStorage<32> > GlobalNoteMap;
 #endif  // POLY_SEQUENCER_FIRMWARE
 
+// In the app arena, past the settings of the dispatcher, the randomizer and the
+// scale processor.
+static const uint16_t kNoteMapArenaOffset = 8;
+static const uint16_t kNoteMapArenaEnd =
+    kNoteMapArenaOffset + sizeof(GlobalNoteMap);
+
 
 Note FactorizeMidiNote(uint8_t note);
 
@@ -44,7 +53,9 @@ uint8_t Transpose(uint8_t note, int8_t by);
 
 uint8_t Constraint(uint8_t note, uint8_t root, uint8_t scale);
 
-extern NoteMap<kNoteMapSize> note_map;
+inline GlobalNoteMap& note_map() {
+  return ArenaObject<GlobalNoteMap, kNoteMapArenaOffset>::get();
+}
 
 }  // namespace midipal
 
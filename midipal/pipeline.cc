@@ -0,0 +1,76 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Chain of apps running in the same firmware.
+
+#include "midipal/pipeline.h"
+
+#ifdef APP_PIPELINE
+
+#include "midipal/apps/arpeggiator.h"
+#include "midipal/apps/delay.h"
+#include "midipal/apps/filter.h"
+#include "midipal/apps/scale_processor.h"
+#include "midipal/apps/splitter.h"
+
+namespace midipal {
+
+#if defined(PIPELINE_FILTER_SCALE_ARPEGGIATOR)
+typedef PipelineChain<
+    0,
+    apps::Filter,
+    apps::ScaleProcessor,
+    apps::Arpeggiator> Stages;
+#elif defined(PIPELINE_SPLITTER_DELAY)
+typedef PipelineChain<
+    0,
+    apps::Splitter,
+    apps::Delay> Stages;
+#endif
+
+/* static */
+uint8_t Pipeline::stage_;
+
+/* static */
+void Pipeline::Init() {
+  // The stages follow the app selector in the app registry.
+  for (uint8_t i = 0; i < kNumPipelineStages; ++i) {
+    App::Launch(i + 1);
+    App::LoadSettings();
+    App::OnInit();
+  }
+  Select(0);
+}
+
+/* static */
+void Pipeline::Forward(uint8_t status, uint8_t* data, uint8_t data_size) {
+  Stages::Receive(stage_ + 1, status, data, data_size);
+}
+
+/* static */
+void Pipeline::ForwardByte(uint8_t byte) {
+  Stages::ReceiveByte(stage_ + 1, byte);
+}
+
+/* static */
+void Pipeline::OnInternalClock(bool realtime) {
+  Stages::Clock(realtime);
+}
+
+}  // namespace midipal
+
+#endif  // APP_PIPELINE
@@ -0,0 +1,195 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Chain of apps running in the same firmware, selected at compile time by
+// one of the PIPELINE_xxx flags. Input bytes are parsed for the first stage;
+// what a stage sends is handed, as a whole message, to the handlers of the
+// next one, without leaving the chip. The last stage writes to the output
+// buffer.
+//
+// The app picked in the app selector gets the UI; all the stages process
+// MIDI with their saved settings.
+
+#ifndef MIDIPAL_PIPELINE_H_
+#define MIDIPAL_PIPELINE_H_
+
+#include "midipal/app.h"
+
+#ifdef APP_PIPELINE
+
+#include "midi/midi.h"
+#include "midipal/app_registry.h"
+
+namespace midipal {
+
+#if defined(PIPELINE_FILTER_SCALE_ARPEGGIATOR)
+static const uint8_t kNumPipelineStages = 3;
+#elif defined(PIPELINE_SPLITTER_DELAY)
+static const uint8_t kNumPipelineStages = 2;
+#endif
+
+class Pipeline {
+ public:
+  // Loads the settings of all the stages and initializes them. The app to
+  // launch must be launched afterwards.
+  static void Init();
+
+  // Directs the MIDI event handlers to a stage. Returns the previous one,
+  // to be restored once the event has been handled.
+  static uint8_t Select(uint8_t stage) {
+    uint8_t previous = stage_;
+    stage_ = stage;
+    // The stages follow the app selector in the app registry.
+    App::set_midi_app_index(stage + 1);
+    return previous;
+  }
+  static uint8_t stage() { return stage_; }
+  static bool last_stage() { return stage_ == kNumPipelineStages - 1; }
+
+  // Hands a message sent by the current stage to the next one.
+  static void Forward(uint8_t status, uint8_t* data, uint8_t data_size);
+  // Same for the bytes the stages send one by one: realtime messages, and
+  // SysEx messages.
+  static void ForwardByte(uint8_t byte);
+
+  // Internal clock ticks go to every stage, from the timer interrupt for the
+  // stages handling them in real time, later for the others.
+  static void OnInternalClock(bool realtime);
+
+ private:
+  static uint8_t stage_;
+
+  DISALLOW_COPY_AND_ASSIGN(Pipeline);
+};
+
+// Handlers of a stage, called with the messages sent by the stage before it.
+// Same as MidiHandler, calling the app directly, without the remote control
+// and the SysEx handler: messages addressed to the MIDIpal are only answered
+// at the input.
+template<typename Stage>
+struct StageHandler : public midi::MidiDevice {
+  static void NoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
+    OnNoteOnCaller::Call<Stage>(0, channel, note, velocity);
+  }
+  static void NoteOff(uint8_t channel, uint8_t note, uint8_t velocity) {
+    OnNoteOffCaller::Call<Stage>(0, channel, note, velocity);
+  }
+  static void Aftertouch(uint8_t channel, uint8_t note, uint8_t velocity) {
+    OnNoteAftertouchCaller::Call<Stage>(0, channel, note, velocity);
+  }
+  static void Aftertouch(uint8_t channel, uint8_t velocity) {
+    OnAftertouchCaller::Call<Stage>(0, channel, velocity);
+  }
+  static void ControlChange(uint8_t channel, uint8_t controller,
+                            uint8_t value) {
+    OnControlChangeCaller::Call<Stage>(0, channel, controller, value);
+  }
+  static void ProgramChange(uint8_t channel, uint8_t program) {
+    OnProgramChangeCaller::Call<Stage>(0, channel, program);
+  }
+  static void PitchBend(uint8_t channel, uint16_t pitch_bend) {
+    OnPitchBendCaller::Call<Stage>(0, channel, pitch_bend);
+  }
+  static void SysExByte(uint8_t sysex_byte) {
+    if (!OnSysExByteCaller::Call<Stage>(0, sysex_byte) &&
+        !OnRawByteRegistered::Call<Stage>(0)) {
+      App::SendNow(sysex_byte);
+    }
+  }
+  static void Clock() { OnClockCaller::Call<Stage>(0, CLOCK_MODE_EXTERNAL); }
+  static void Start() { OnStartCaller::Call<Stage>(0); }
+  static void Continue() { OnContinueCaller::Call<Stage>(0); }
+  static void Stop() { OnStopCaller::Call<Stage>(0); }
+  static void SongPosition(uint16_t position) {
+    OnSongPositionCaller::Call<Stage>(0, position);
+  }
+  static void QuarterFrame(uint8_t data) {
+    OnQuarterFrameCaller::Call<Stage>(0, data);
+  }
+  static uint8_t CheckChannel(uint8_t channel) {
+    return CheckChannelCaller::Call<Stage>(0, channel);
+  }
+  static void RawMidiData(uint8_t status, uint8_t* data, uint8_t data_size) {
+    OnRawMidiDataCaller::Call<Stage>(0, status, data, data_size);
+  }
+};
+
+// Stages n and up of a pipeline. Each stage's messages go straight to the
+// handlers of the next one: the comparison chain on the index of the sending
+// stage is resolved inline, and the handlers are static methods.
+template<uint8_t n, typename... Stages>
+struct PipelineChain {
+  static inline void Receive(
+      uint8_t stage, uint8_t status, uint8_t* data, uint8_t data_size) { }
+  static inline void ReceiveByte(uint8_t stage, uint8_t byte) { }
+  static inline void Clock(bool realtime) { }
+};
+
+template<uint8_t n, typename Stage, typename... Next>
+struct PipelineChain<n, Stage, Next...> {
+  typedef StageHandler<Stage> Handler;
+
+  // Delivers a message to stage.
+  static inline void Receive(
+      uint8_t stage, uint8_t status, uint8_t* data, uint8_t data_size) {
+    if (stage != n) {
+      PipelineChain<n + 1, Next...>::Receive(stage, status, data, data_size);
+      return;
+    }
+    uint8_t previous = Pipeline::Select(n);
+    if (OnRawByteRegistered::Call<Stage>(0)) {
+      OnRawByteCaller::Call<Stage>(0, status);
+      for (uint8_t i = 0; i < data_size; ++i) {
+        OnRawByteCaller::Call<Stage>(0, data[i]);
+      }
+    }
+    midi::MidiStreamParser<Handler>::Dispatch(status, data, data_size);
+    Pipeline::Select(previous);
+  }
+
+  // Delivers a realtime byte, or a byte of a SysEx message, to stage.
+  static inline void ReceiveByte(uint8_t stage, uint8_t byte) {
+    if (stage != n) {
+      PipelineChain<n + 1, Next...>::ReceiveByte(stage, byte);
+      return;
+    }
+    if (byte >= 0xf8) {
+      Receive(stage, byte, &byte, 0);
+      return;
+    }
+    uint8_t previous = Pipeline::Select(n);
+    OnRawByteCaller::Call<Stage>(0, byte);
+    Handler::SysExByte(byte);
+    Pipeline::Select(previous);
+  }
+
+  static inline void Clock(bool realtime) {
+    if (pgm_read_byte(&Stage::app_info_.realtime_clock_handling) ==
+        realtime) {
+      uint8_t previous = Pipeline::Select(n);
+      OnClockCaller::Call<Stage>(0, CLOCK_MODE_INTERNAL);
+      Pipeline::Select(previous);
+    }
+    PipelineChain<n + 1, Next...>::Clock(realtime);
+  }
+};
+
+}  // namespace midipal
+
+#endif  // APP_PIPELINE
+
+#endif  // MIDIPAL_PIPELINE_H_
@@ -0,0 +1,93 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Measurement of the time spent in the interrupt handlers.
+
+#include "midipal/profiler.h"
+
+#ifdef ENABLE_ISR_PROFILER
+
+#include <avr/interrupt.h>
+#include <string.h>
+
+#include "avrlib/timer.h"
+
+namespace midipal {
+
+using namespace avrlib;
+
+/* static */
+SectionStats Profiler::stats_[PROFILER_SECTION_LAST];
+
+/* static */
+volatile uint8_t Profiler::overflows_;
+
+/* static */
+uint16_t Profiler::app_time_;
+
+/* static */
+void Profiler::Init() {
+  memset(stats_, 0, sizeof(stats_));
+  // Free running. The overflow interrupt extends the count to 16 bits.
+  Timer<0>::set_mode(TIMER_NORMAL);
+  Timer<0>::set_prescaler(3);
+  Timer<0>::Start();
+}
+
+/* static */
+void Profiler::Update(ProfilerSection section, uint16_t duration) {
+  SectionStats* s = &stats_[section];
+  if (duration > s->max) {
+    s->max = duration;
+  }
+  // Exponential moving average, with a time constant of 16 samples. Durations
+  // above 4095 counts saturate it.
+  if (duration > 0xfff) {
+    duration = 0xfff;
+  }
+  uint16_t sample = duration << 4;
+  if (sample > s->average) {
+    s->average += (sample - s->average) >> 4;
+  } else {
+    s->average -= (s->average - sample) >> 4;
+  }
+  if (duration > kIsrBudget && s->overruns != 0xffff) {
+    ++s->overruns;
+  }
+}
+
+/* static */
+uint8_t Profiler::Snapshot(uint8_t* buffer) {
+  uint8_t* p = buffer;
+  uint8_t sreg = SREG;
+  cli();
+  for (uint8_t i = 0; i < PROFILER_SECTION_LAST; ++i) {
+    *p++ = stats_[i].max >> 8;
+    *p++ = stats_[i].max & 0xff;
+    *p++ = stats_[i].average >> 8;
+    *p++ = stats_[i].average & 0xff;
+    *p++ = stats_[i].overruns >> 8;
+    *p++ = stats_[i].overruns & 0xff;
+  }
+  memset(stats_, 0, sizeof(stats_));
+  SREG = sreg;
+  return p - buffer;
+}
+
+}  // namespace midipal
+
+#endif  // ENABLE_ISR_PROFILER
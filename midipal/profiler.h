@@ -0,0 +1,122 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Measurement of the time spent in the interrupt handlers.
+//
+// Enabled by defining ENABLE_ISR_PROFILER. Timer 0 then runs freely with a
+// /64 prescaler (3.2us per count at 20MHz), its overflows counted in software
+// to extend it to 16 bits (210ms), and each section of the interrupt handlers
+// records its worst case and average duration, along with the number of times
+// it took longer than a period of the 4kHz interrupt. The app handlers called
+// by the parser are timed on their own, and taken out of the input section.
+// The time spent in TIMER1 is included in the TIMER2 sections it interrupts.
+//
+// When ENABLE_ISR_PROFILER is not defined, everything compiles to nothing.
+
+#ifndef MIDIPAL_PROFILER_H_
+#define MIDIPAL_PROFILER_H_
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+#include "avrlib/base.h"
+
+namespace midipal {
+
+enum ProfilerSection {
+  PROFILER_SECTION_INPUT,  // Parsing.
+  PROFILER_SECTION_APP,  // App handlers called by the parser.
+  PROFILER_SECTION_CLOCK,  // Deferred clock ticks.
+  PROFILER_SECTION_UI,
+  PROFILER_SECTION_TIMER2,  // Whole TIMER2 handler.
+  PROFILER_SECTION_TIMER1,  // Whole TIMER1 handler.
+  PROFILER_SECTION_LAST
+};
+
+struct SectionStats {
+  uint16_t max;  // In timer 0 counts.
+  uint16_t average;  // In timer 0 counts, 12.4 fixed point.
+  uint16_t overruns;
+};
+
+// Period of TIMER2 (510 counts of a /8 prescaled timer), in timer 0 counts.
+static const uint8_t kIsrBudget = 510 * 8 / 64;
+
+class Profiler {
+ public:
+#ifdef ENABLE_ISR_PROFILER
+  static void Init();
+  // Called by the timer 0 overflow interrupt.
+  static inline void Overflow() { ++overflows_; }
+  static inline uint16_t now() {
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t count = TCNT0;
+    uint8_t overflows = overflows_;
+    // The overflow has not been counted yet if interrupts were disabled when
+    // it happened - as in TIMER1, or in a cli() section.
+    if ((TIFR0 & bitFlag8(TOV0)) && count < 0x80) {
+      ++overflows;
+    }
+    SREG = sreg;
+    return (static_cast<uint16_t>(overflows) << 8) | count;
+  }
+  // Records the duration of a section started at start.
+  static inline void Record(ProfilerSection section, uint16_t start) {
+    Update(section, now() - start);
+  }
+  // Total time spent in the app handlers called by the parser, wrapping
+  // around. Handlers add the time elapsed since start to it.
+  static inline uint16_t app_time() { return app_time_; }
+  static inline void AddAppTime(uint16_t start) {
+    app_time_ += now() - start;
+  }
+  // Records the input section started at start, app_start being app_time()
+  // at that point: the parsing and the app handlers separately.
+  static inline void RecordInput(uint16_t start, uint16_t app_start) {
+    uint16_t duration = now() - start;
+    uint16_t app_duration = app_time_ - app_start;
+    Update(PROFILER_SECTION_INPUT, duration - app_duration);
+    Update(PROFILER_SECTION_APP, app_duration);
+  }
+  // Copies the statistics to buffer and resets them. Returns the number of
+  // bytes written.
+  static uint8_t Snapshot(uint8_t* buffer);
+
+ private:
+  static void Update(ProfilerSection section, uint16_t duration);
+
+  static SectionStats stats_[PROFILER_SECTION_LAST];
+  static volatile uint8_t overflows_;
+  static uint16_t app_time_;
+#else
+  static inline void Init() { }
+  static inline void Overflow() { }
+  static inline uint16_t now() { return 0; }
+  static inline void Record(ProfilerSection section, uint16_t start) { }
+  static inline uint16_t app_time() { return 0; }
+  static inline void AddAppTime(uint16_t start) { }
+  static inline void RecordInput(uint16_t start, uint16_t app_start) { }
+  static inline uint8_t Snapshot(uint8_t* buffer) { return 0; }
+#endif  // ENABLE_ISR_PROFILER
+
+  DISALLOW_COPY_AND_ASSIGN(Profiler);
+};
+
+}  // namespace midipal
+
+#endif  // MIDIPAL_PROFILER_H_
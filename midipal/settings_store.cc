@@ -0,0 +1,330 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Write-behind cache of the settings of the running app.
+
+#include "midipal/settings_store.h"
+
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#include "midipal/app.h"
+#include "midipal/app_registry.h"
+
+namespace midipal {
+
+// Journal entries are a tag and a value. The tag holds the app index and the
+// flag (running_ or recording_), and a lap bit flipped on every pass over the
+// journal: the next entry to write is the first one whose lap bit differs from
+// the first entry's. 0xff is an entry which has never been written.
+static const uint8_t kEmptyTag = 0xff;
+static const uint8_t kLapBit = 0x80;
+
+static inline uint8_t* eeprom_address(uint16_t address) {
+  return reinterpret_cast<uint8_t*>(address);
+}
+
+static inline uint16_t log_address(uint8_t entry) {
+  return SETTINGS_FLAG_LOG + 2 * entry;
+}
+
+/* static */
+uint8_t SettingsStore::dirty_[
+    (AppRegistry::max_settings_size + kSettingsPageSize * 8 - 1) /
+    (kSettingsPageSize * 8)];
+
+/* static */
+uint8_t SettingsStore::num_dirty_;
+
+/* static */
+uint16_t SettingsStore::cursor_;
+
+/* static */
+uint8_t SettingsStore::page_size_;
+
+/* static */
+uint8_t SettingsStore::log_step_;
+
+/* static */
+uint8_t SettingsStore::log_head_;
+
+/* static */
+uint8_t SettingsStore::log_tag_;
+
+/* static */
+uint8_t SettingsStore::log_value_;
+
+/* static */
+WriteCounter SettingsStore::write_counters_[kNumWriteCounters];
+
+enum LogStep {
+  LOG_STEP_NONE,
+  LOG_STEP_CHECKPOINT,
+  LOG_STEP_TAG,
+  LOG_STEP_VALUE
+};
+
+/* static */
+void SettingsStore::MarkDirty(uint16_t key) {
+  if (key >= App::settings_size()) {
+    return;
+  }
+  uint8_t page = key / kSettingsPageSize;
+  uint8_t mask = 1 << (page & 7);
+  uint8_t sreg = SREG;
+  cli();
+  if (!(dirty_[page >> 3] & mask)) {
+    dirty_[page >> 3] |= mask;
+    ++num_dirty_;
+  }
+  SREG = sreg;
+}
+
+/* static */
+void SettingsStore::MarkAllDirty() {
+  for (uint16_t key = 0; key < App::settings_size();
+       key += kSettingsPageSize) {
+    MarkDirty(key);
+  }
+}
+
+/* static */
+bool SettingsStore::Commit() {
+  if (!num_dirty_ && !page_size_ && !log_step_) {
+    return false;
+  }
+  if (!eeprom_is_ready()) {
+    return true;
+  }
+  while (true) {
+    if (log_step_) {
+      if (WriteLogStep()) {
+        return true;
+      }
+      continue;
+    }
+    if (!page_size_ && !NextDirtyPage()) {
+      return false;
+    }
+    uint16_t key = cursor_++;
+    --page_size_;
+    uint8_t value = App::settings_data()[key];
+    if (!LogFlag(key, value) &&
+        WriteByte(App::settings_offset() + key, value)) {
+      return true;
+    }
+  }
+}
+
+/* static */
+bool SettingsStore::NextDirtyPage() {
+  // The page is clean again as soon as its first byte is checked: a setting
+  // saved from an interrupt while the page is being written marks it again.
+  uint16_t size = App::settings_size();
+  uint8_t num_pages = (size + kSettingsPageSize - 1) / kSettingsPageSize;
+  uint8_t page = cursor_ / kSettingsPageSize;
+  for (uint8_t i = 0; i < num_pages; ++i, ++page) {
+    if (page >= num_pages) {
+      page = 0;
+    }
+    uint8_t mask = 1 << (page & 7);
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t dirty = dirty_[page >> 3] & mask;
+    if (dirty) {
+      dirty_[page >> 3] &= ~mask;
+      --num_dirty_;
+    }
+    SREG = sreg;
+    if (dirty) {
+      cursor_ = page * kSettingsPageSize;
+      page_size_ = size - cursor_ < kSettingsPageSize
+          ? size - cursor_
+          : kSettingsPageSize;
+      return true;
+    }
+  }
+  return false;
+}
+
+/* static */
+void SettingsStore::ApplyFlagLog() {
+  uint8_t head = FindLogHead();
+  for (uint8_t i = 0; i < kFlagLogSize; ++i) {
+    uint8_t entry = (head + i) % kFlagLogSize;
+    uint8_t tag = log_tag(entry) & ~kLapBit;
+    if ((tag >> 1) != App::app_index()) {
+      continue;
+    }
+    uint8_t key = pgm_read_byte(
+        &AppRegistry::logged_flags[App::app_index()][tag & 1]);
+    if (key != kNoKey) {
+      App::settings_data()[key] = eeprom_read_byte(
+          eeprom_address(log_address(entry) + 1));
+    }
+  }
+}
+
+/* static */
+bool SettingsStore::LogFlag(uint16_t key, uint8_t value) {
+  uint8_t flag = 0;
+  while (true) {
+    uint8_t flag_key = pgm_read_byte(
+        &AppRegistry::logged_flags[App::app_index()][flag]);
+    if (flag_key != kNoKey && flag_key == key) {
+      break;
+    }
+    if (++flag == kNumLoggedFlags) {
+      return false;
+    }
+  }
+  uint8_t tag = App::app_index() << 1 | flag;
+  uint8_t head = FindLogHead();
+
+  // Nothing to write if the journal, or the flag's own location, already
+  // holds this value.
+  uint8_t current = eeprom_read_byte(eeprom_address(FlagAddress(tag)));
+  for (uint8_t i = 0; i < kFlagLogSize; ++i) {
+    uint8_t entry = (head + i) % kFlagLogSize;
+    if ((log_tag(entry) & ~kLapBit) == tag) {
+      current = eeprom_read_byte(eeprom_address(log_address(entry) + 1));
+    }
+  }
+  if (current == value) {
+    return true;
+  }
+
+  uint8_t lap = log_tag(0) & kLapBit;
+  if (head == 0) {
+    lap ^= kLapBit;
+  }
+  log_head_ = head;
+  log_tag_ = tag | lap;
+  log_value_ = value;
+  log_step_ = LOG_STEP_CHECKPOINT;
+  return true;
+}
+
+/* static */
+bool SettingsStore::WriteLogStep() {
+  switch (log_step_) {
+    case LOG_STEP_CHECKPOINT:
+      {
+        // The entry at the head is the oldest one. If no other entry
+        // supersedes it, its value moves to the flag's own location.
+        log_step_ = LOG_STEP_TAG;
+        uint8_t oldest_tag = log_tag(log_head_) & ~kLapBit;
+        if (!FlagAddress(oldest_tag)) {
+          return false;
+        }
+        for (uint8_t i = 1; i < kFlagLogSize; ++i) {
+          uint8_t entry = (log_head_ + i) % kFlagLogSize;
+          if ((log_tag(entry) & ~kLapBit) == oldest_tag) {
+            return false;
+          }
+        }
+        return WriteByte(
+            FlagAddress(oldest_tag),
+            eeprom_read_byte(eeprom_address(log_address(log_head_) + 1)));
+      }
+
+    case LOG_STEP_TAG:
+      log_step_ = LOG_STEP_VALUE;
+      return WriteByte(log_address(log_head_), log_tag_);
+
+    default:
+      log_step_ = LOG_STEP_NONE;
+      return WriteByte(log_address(log_head_) + 1, log_value_);
+  }
+}
+
+/* static */
+uint16_t SettingsStore::FlagAddress(uint8_t tag) {
+  // Returns 0 for an empty entry, or an entry written by a firmware with
+  // another list of apps.
+  uint8_t app = tag >> 1;
+  if (tag == (kEmptyTag & ~kLapBit) || app >= AppRegistry::size) {
+    return 0;
+  }
+  uint8_t key = pgm_read_byte(&AppRegistry::logged_flags[app][tag & 1]);
+  if (key == kNoKey) {
+    return 0;
+  }
+  return pgm_read_word(&AppRegistry::info[app]->settings_offset) + key;
+}
+
+/* static */
+uint8_t SettingsStore::FindLogHead() {
+  uint8_t lap = log_tag(0) & kLapBit;
+  for (uint8_t entry = 1; entry < kFlagLogSize; ++entry) {
+    if ((log_tag(entry) & kLapBit) != lap) {
+      return entry;
+    }
+  }
+  return 0;
+}
+
+/* static */
+uint8_t SettingsStore::log_tag(uint8_t entry) {
+  return eeprom_read_byte(eeprom_address(log_address(entry)));
+}
+
+/* static */
+bool SettingsStore::WriteByte(uint16_t address, uint8_t value) {
+  if (eeprom_read_byte(eeprom_address(address)) == value) {
+    return false;
+  }
+  eeprom_write_byte(eeprom_address(address), value);
+  CountWrite(address);
+  return true;
+}
+
+/* static */
+void SettingsStore::CountWrite(uint16_t address) {
+  // When all the counters are taken, the least used one goes to the new
+  // address, which inherits its count: see SnapshotWriteCounts().
+  WriteCounter* counter = &write_counters_[0];
+  for (uint8_t i = 0; i < kNumWriteCounters; ++i) {
+    WriteCounter* c = &write_counters_[i];
+    if (c->count && c->address == address) {
+      counter = c;
+      break;
+    }
+    if (c->count < counter->count) {
+      counter = c;
+    }
+  }
+  counter->address = address;
+  if (counter->count != 0xffff) {
+    ++counter->count;
+  }
+}
+
+/* static */
+uint8_t SettingsStore::SnapshotWriteCounts(uint8_t* buffer) {
+  uint8_t* p = buffer;
+  for (uint8_t i = 0; i < kNumWriteCounters; ++i) {
+    *p++ = write_counters_[i].address >> 8;
+    *p++ = write_counters_[i].address & 0xff;
+    *p++ = write_counters_[i].count >> 8;
+    *p++ = write_counters_[i].count & 0xff;
+  }
+  return p - buffer;
+}
+
+}  // namespace midipal
@@ -0,0 +1,98 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Write-behind cache of the settings of the running app. Saving a setting
+// only marks its page of kSettingsPageSize bytes as dirty; the main loop then
+// writes at most one byte per pass to the EEPROM, and only if its content
+// differs.
+//
+// The running_ and recording_ settings, toggled all the time, do not go to
+// their own location: they are appended to a journal of kFlagLogSize entries
+// shared by all the apps, so that the writes rotate across it. When an entry
+// holding the last value of a flag is about to be recycled, that value is
+// written to the flag's own location.
+
+#ifndef MIDIPAL_SETTINGS_STORE_H_
+#define MIDIPAL_SETTINGS_STORE_H_
+
+#include "avrlib/base.h"
+
+namespace midipal {
+
+static const uint8_t kFlagLogSize = 16;  // Entries of 2 bytes.
+static const uint8_t kSettingsPageSize = 8;
+static const uint8_t kNumWriteCounters = 8;
+
+struct WriteCounter {
+  uint16_t address;
+  uint16_t count;
+};
+
+class SettingsStore {
+ public:
+  // Can be called from the interrupt handlers.
+  static void MarkDirty(uint16_t key);
+  static void MarkAllDirty();
+  // Writes at most one byte. Returns false once nothing is left to write.
+  static bool Commit();
+  static void Flush() {
+    while (Commit());
+  }
+
+  // Applies the journal entries of the running app to its settings, once
+  // they have been read from the EEPROM.
+  static void ApplyFlagLog();
+
+  // Copies the addresses written most often since boot, with their number of
+  // writes, to buffer. Returns the number of bytes written.
+  //
+  // Only kNumWriteCounters addresses are tracked, so these are estimates: an
+  // address taking over the counter of the least written one starts from its
+  // count. A count is thus never below the actual number of writes, and
+  // exceeds it by at most the count the address inherited. An address which
+  // took more than 1 / kNumWriteCounters of the writes since boot is always
+  // listed; the others may not be.
+  static uint8_t SnapshotWriteCounts(uint8_t* buffer);
+
+ private:
+  static bool WriteByte(uint16_t address, uint8_t value);
+  static bool NextDirtyPage();
+  static bool LogFlag(uint16_t key, uint8_t value);
+  static bool WriteLogStep();
+  static uint16_t FlagAddress(uint8_t tag);
+  static uint8_t FindLogHead();
+  static uint8_t log_tag(uint8_t entry);
+  static void CountWrite(uint16_t address);
+
+  static uint8_t dirty_[];  // One bit per page.
+  static uint8_t num_dirty_;  // Pages.
+  static uint16_t cursor_;
+  static uint8_t page_size_;  // Bytes left to check from cursor_.
+
+  // Journal entry being written, one byte per call to Commit().
+  static uint8_t log_step_;
+  static uint8_t log_head_;
+  static uint8_t log_tag_;
+  static uint8_t log_value_;
+  static WriteCounter write_counters_[kNumWriteCounters];
+
+  DISALLOW_COPY_AND_ASSIGN(SettingsStore);
+};
+
+}  // namespace midipal
+
+#endif  // MIDIPAL_SETTINGS_STORE_H_
@@ -0,0 +1,82 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Stack high-water mark.
+
+#include "midipal/stack_monitor.h"
+
+#include <avr/io.h>
+
+// Defined by the linker and by avr-libc's malloc.
+extern uint8_t __data_start, __data_end, __bss_start, __bss_end, __heap_start;
+extern uint8_t* __brkval;
+
+namespace midipal {
+
+/* static */
+uint8_t* StackMonitor::lowest_;
+
+/* static */
+uint8_t* StackMonitor::cursor_;
+
+/* static */
+void StackMonitor::Init() {
+  uint8_t* stack = reinterpret_cast<uint8_t*>(SP);
+  cursor_ = heap_end();
+  for (uint8_t* p = cursor_; p < stack; ++p) {
+    *p = kStackCanary;
+  }
+  lowest_ = stack;
+}
+
+/* static */
+void StackMonitor::Scan() {
+  for (uint8_t i = 0; i < kStackScanBytesPerPass; ++i) {
+    if (cursor_ >= lowest_) {
+      cursor_ = heap_end();
+      return;
+    }
+    if (*cursor_ != kStackCanary) {
+      lowest_ = cursor_;
+      cursor_ = heap_end();
+      return;
+    }
+    ++cursor_;
+  }
+}
+
+/* static */
+uint8_t* StackMonitor::heap_end() {
+  return __brkval ? __brkval : &__heap_start;
+}
+
+/* static */
+uint16_t StackMonitor::heap_size() {
+  return heap_end() - &__heap_start;
+}
+
+/* static */
+uint16_t StackMonitor::bss_size() {
+  return &__bss_end - &__bss_start;
+}
+
+/* static */
+uint16_t StackMonitor::data_size() {
+  return &__data_end - &__data_start;
+}
+
+}  // namespace midipal
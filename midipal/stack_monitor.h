@@ -0,0 +1,57 @@
+// Copyright 2011 Olivier Gillet.
+//
+// Author: Olivier Gillet (ol.gillet@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// -----------------------------------------------------------------------------
+//
+// Stack high-water mark. The free RAM between the heap and the stack is
+// filled with a canary value at boot; the main loop then looks, a few bytes
+// at a time, for the lowest byte which has been overwritten. Since switching
+// apps resets the MIDIpal, the figure is that of the running app.
+
+#ifndef MIDIPAL_STACK_MONITOR_H_
+#define MIDIPAL_STACK_MONITOR_H_
+
+#include "avrlib/base.h"
+
+namespace midipal {
+
+static const uint8_t kStackCanary = 0xc5;
+static const uint8_t kStackScanBytesPerPass = 8;
+
+class StackMonitor {
+ public:
+  // Must be called at boot, before the interrupts are enabled.
+  static void Init();
+  // Checks the next kStackScanBytesPerPass bytes.
+  static void Scan();
+
+  // Smallest number of bytes left between the heap and the stack, since boot.
+  static uint16_t min_free() { return lowest_ - heap_end(); }
+  static uint16_t heap_size();
+  static uint16_t bss_size();
+  static uint16_t data_size();
+
+ private:
+  static uint8_t* heap_end();
+
+  static uint8_t* lowest_;  // Lowest byte used by the stack.
+  static uint8_t* cursor_;
+
+  DISALLOW_COPY_AND_ASSIGN(StackMonitor);
+};
+
+}  // namespace midipal
+
+#endif  // MIDIPAL_STACK_MONITOR_H_
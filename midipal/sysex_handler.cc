@@ -20,6 +20,7 @@
 #include "midipal/sysex_handler.h"
 
 #include <avr/eeprom.h>
+#include <avr/interrupt.h>
 #include <avr/pgmspace.h>
 
 #include "avrlib/op.h"
@@ -28,14 +29,21 @@
 #include "avrlib/watchdog_timer.h"
 
 #include "midipal/app.h"
+#include "midipal/app_registry.h"
 #include "midipal/apps/generic_filter.h"
+#include "midipal/engine.h"
 #include "midipal/hardware_config.h"
+#include "midipal/profiler.h"
+#include "midipal/settings_store.h"
+#include "midipal/stack_monitor.h"
 #include "midipal/ui.h"
 
 namespace midipal {
 
 using namespace avrlib;
 
+using MidiOut = Serial<MidiPort, 31250, DISABLED, POLLED>;
+
 /* static */
 uint8_t SysExHandler::buffer_[kSysExTransferBlockSize + 4];
 
@@ -63,9 +71,14 @@ static const uint8_t header[] PROGMEM = {
   // - 0x01: data transfer
   // - 0x02: change current app
   // - 0x11: data request
+  // - 0x12: diagnostics request
   // * Argument byte:
-  // - Block size ; 0 for app change request.
-  // * 16-bits address in program memory.
+  // - Block size ; 0 for app change request ; diagnostics page for a
+  //   diagnostics request (0: interrupt timings, 1: output buffer usage,
+  //   2: input errors, 3: free stack, heap, .bss and .data sizes, 4: EEPROM
+  //   addresses written most often since boot, with their write counts -
+  //   upper bounds, from only 8 counters, see SettingsStore).
+  // * 16-bits address in program memory, for data transfers and requests.
 };
 
 /* static */
@@ -78,6 +91,7 @@ void SysExHandler::ParseCommand() {
       break;
     
     case 0x02:
+    case 0x12:
       expected_size_ = 0;
       break;
 
@@ -107,7 +121,12 @@ void SysExHandler::CopyScratchArea() {
   eeprom_write_block(&buffer_[0], dst, 32);
   eeprom_read_block(&buffer_[0], src + 32, 32);
   eeprom_write_block(&buffer_[0], dst + 32, 32);
-  apps::GenericFilter::SetParameter(0, active_program);
+  // The settings of the running app share their RAM with those of the
+  // GenericFilter. If it is not the one running, it loads the program
+  // selected in the EEPROM, where active_program was read, when launched.
+  if (AppRegistry::info[App::app_index()] == &apps::GenericFilter::app_info_) {
+    apps::GenericFilter::SetParameter(0, active_program);
+  }
 }
 
 /* static */
@@ -115,7 +134,7 @@ void SysExHandler::AcceptCommand() {
   Word address;
   address.bytes[0] = buffer_[0];
   address.bytes[1] = buffer_[1];
-  void* p = (void*)(address.value);
+  void* p = (void*)(uintptr_t)(address.value);
   switch (command_[0]) {
     case 0x01:  // Data transfer
       eeprom_write_block(&buffer_[2], p, command_[1]);
@@ -126,6 +145,7 @@ void SysExHandler::AcceptCommand() {
       App::Init();
       App::SetParameter(0, command_[1]);
       App::SaveSettings();
+      SettingsStore::Flush();
       SystemReset(100);
       while (1);
       break;
@@ -133,56 +153,37 @@ void SysExHandler::AcceptCommand() {
       CopyScratchArea();
       break;
     case 0x11:
-      SendBlock((void*)(address.value), command_[1]);
+      SendBlock((void*)(uintptr_t)(address.value), command_[1]);
+      break;
+    case 0x12:
+      SendDiagnostics(command_[1]);
       break;
   }
 }
 
 /* static */
 void SysExHandler::SendBlock(void* address, uint8_t size) {
-  // Wait until the MIDI queue is flushed.
-  Serial<MidiPort, 31250, DISABLED, POLLED> midi_output;
-  
   uint16_t remaining_size = size;
   uint8_t* p = (uint8_t*)(address);
   if (remaining_size == 0) {
-    remaining_size = kEepromSize - (uint16_t)(address);
+    remaining_size = kEepromSize - (uint16_t)(uintptr_t)(address);
   }
   while (remaining_size) {
     uint8_t block_size = (remaining_size > kSysExTransferBlockSize) ? 
       kSysExTransferBlockSize : remaining_size;
     
-    // Outputs the SysEx header.
-    for (uint8_t i = 0; i < sizeof(header); ++i) {
-      midi_output.Write(pgm_read_byte(header + i));
-    }
-    // Command: transfer.
-    midi_output.Write(0x01);
-    // Argument: size
-    midi_output.Write(block_size);
-
     // First two bytes of data: address.
     {
       Word address;
-      address.value = (uint16_t)(void*)(p);
+      address.value = (uint16_t)(uintptr_t)(p);
       buffer_[0] = address.bytes[0];
       buffer_[1] = address.bytes[1];
     }
     // And then the data.
     eeprom_read_block(&buffer_[2], p, block_size);
 
-    // Send the data and the checksum.
-    uint8_t checksum = 0;
-    for (uint8_t i = 0; i < block_size + 2; ++i) {
-      checksum += buffer_[i];
-      midi_output.Write(U8ShiftRight4(buffer_[i]));
-      midi_output.Write(buffer_[i] & 0x0f);
-    }
-
-    midi_output.Write(U8ShiftRight4(checksum));
-    midi_output.Write(checksum & 0x0f);
-
-    midi_output.Write(0xf7);  // </SysEx>
+    // Command: transfer ; argument: size.
+    SendBuffer(0x01, block_size, block_size + 2);
     
     remaining_size -= block_size;
     p += block_size;
@@ -193,6 +194,90 @@ void SysExHandler::SendBlock(void* address, uint8_t size) {
   }
 }
 
+/* static */
+void SysExHandler::SendDiagnostics(uint8_t page) {
+  uint8_t size = 0;
+  switch (page) {
+    case 0:
+      size = Profiler::Snapshot(&buffer_[0]);
+      break;
+    case 1:
+      buffer_[0] = App::output_high_water();
+      buffer_[1] = App::output_stalls() >> 8;
+      buffer_[2] = App::output_stalls() & 0xff;
+      buffer_[3] = App::output_drops() >> 8;
+      buffer_[4] = App::output_drops() & 0xff;
+      App::ResetOutputStatistics();
+      size = 5;
+      break;
+    case 2:
+      size = Engine::SnapshotInputErrors(&buffer_[0]);
+      break;
+    case 3:
+      {
+        uint16_t values[] = {
+          StackMonitor::min_free(),
+          StackMonitor::heap_size(),
+          StackMonitor::bss_size(),
+          StackMonitor::data_size()
+        };
+        for (uint8_t i = 0; i < 4; ++i) {
+          buffer_[size++] = values[i] >> 8;
+          buffer_[size++] = values[i] & 0xff;
+        }
+      }
+      break;
+    case 4:
+      size = SettingsStore::SnapshotWriteCounts(&buffer_[0]);
+      break;
+  }
+  SendBuffer(0x12, page, size);
+}
+
+/* static */
+void SysExHandler::Write(uint8_t byte) {
+  // The timer interrupt may send a realtime byte between the test and the
+  // write.
+  while (true) {
+    uint8_t sreg = SREG;
+    cli();
+    bool sent = MidiOut::writable();
+    if (sent) {
+      MidiOut::Overwrite(byte);
+    }
+    SREG = sreg;
+    if (sent) {
+      break;
+    }
+  }
+}
+
+/* static */
+void SysExHandler::SendBuffer(uint8_t command, uint8_t argument, uint8_t size) {
+  Engine::BeginSysExOutput();
+
+  // Outputs the SysEx header.
+  for (uint8_t i = 0; i < sizeof(header); ++i) {
+    Write(pgm_read_byte(header + i));
+  }
+  Write(command);
+  Write(argument);
+
+  // Send the data and the checksum.
+  uint8_t checksum = 0;
+  for (uint8_t i = 0; i < size; ++i) {
+    checksum += buffer_[i];
+    Write(U8ShiftRight4(buffer_[i]));
+    Write(buffer_[i] & 0x0f);
+  }
+
+  Write(U8ShiftRight4(checksum));
+  Write(checksum & 0x0f);
+
+  Write(0xf7);  // </SysEx>
+  Engine::EndSysExOutput();
+}
+
 /* static */
 void SysExHandler::Receive(uint8_t byte) {
   if (byte == 0xf0) {
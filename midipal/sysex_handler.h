@@ -40,8 +40,13 @@ class SysExHandler {
  public:
   static void Receive(uint8_t byte);
   static void SendBlock(void* address, uint8_t size);
+  static void SendDiagnostics(uint8_t page);
   
  private:
+  // Sends the first size bytes of buffer_, nibblized.
+  static void SendBuffer(uint8_t command, uint8_t argument, uint8_t size);
+  static void Write(uint8_t byte);
+
   static void ParseCommand();
   static void AcceptCommand();
 
@@ -24,90 +24,138 @@
 namespace midipal {
 
 /* static */
-VoiceEntry VoiceAllocator::pool_[kMaxPolyphony];
+void VoiceAllocator::Clear() {
+  Tables& t = tables();
+  memset(t.note, kNoNote, sizeof(t.note));
+  memset(t.active, 0, sizeof(t.active));
+  memset(t.note_voice, kNoVoice, sizeof(t.note_voice));
+  memset(t.head, kNoVoice, sizeof(t.head));
+  memset(t.tail, kNoVoice, sizeof(t.tail));
+  uint8_t size = t.size;
+  t.size = 0;
+  Resize(size);
+}
 
 /* static */
-uint8_t VoiceAllocator::size_;
+void VoiceAllocator::Resize(uint8_t size) {
+  Tables& t = tables();
+  // Voices beyond the new size leave the lists...
+  while (t.size > size) {
+    --t.size;
+    Unlink(t.size);
+    if (t.note_voice[U7(t.note[t.size])] == t.size) {
+      t.note_voice[U7(t.note[t.size])] = kNoVoice;
+    }
+  }
+  // ...and voices brought back join them as the least recently used, the
+  // lowest one last.
+  for (uint8_t i = size; i > t.size; --i) {
+    Link(i - 1, false);
+  }
+  for (; t.size < size; ++t.size) {
+    if (t.note[t.size] != kNoNote &&
+        t.note_voice[U7(t.note[t.size])] == kNoVoice) {
+      t.note_voice[U7(t.note[t.size])] = t.size;
+    }
+  }
+}
 
 /* static */
-uint8_t VoiceAllocator::lru_[kMaxPolyphony];
+void VoiceAllocator::set_active(uint8_t voice, bool active) {
+  Tables& t = tables();
+  uint8_t mask = 1 << (voice & 7);
+  if (active) {
+    t.active[voice >> 3] |= mask;
+  } else {
+    t.active[voice >> 3] &= ~mask;
+  }
+}
 
 /* static */
-void VoiceAllocator::Clear() {
-  memset(&pool_, 0, sizeof(pool_));
-  for (uint8_t i = 0; i < kMaxPolyphony; ++i) {
-    lru_[i] = kMaxPolyphony - i - 1;
+void VoiceAllocator::Link(uint8_t voice, bool at_head) {
+  Tables& t = tables();
+  uint8_t list = active(voice) ? ACTIVE_VOICES : RELEASED_VOICES;
+  if (at_head) {
+    t.previous[voice] = kNoVoice;
+    t.next[voice] = t.head[list];
+    if (t.head[list] != kNoVoice) {
+      t.previous[t.head[list]] = voice;
+    } else {
+      t.tail[list] = voice;
+    }
+    t.head[list] = voice;
+  } else {
+    t.next[voice] = kNoVoice;
+    t.previous[voice] = t.tail[list];
+    if (t.tail[list] != kNoVoice) {
+      t.next[t.tail[list]] = voice;
+    } else {
+      t.head[list] = voice;
+    }
+    t.tail[list] = voice;
+  }
+}
+
+/* static */
+void VoiceAllocator::Unlink(uint8_t voice) {
+  Tables& t = tables();
+  uint8_t list = active(voice) ? ACTIVE_VOICES : RELEASED_VOICES;
+  if (t.previous[voice] != kNoVoice) {
+    t.next[t.previous[voice]] = t.next[voice];
+  } else {
+    t.head[list] = t.next[voice];
+  }
+  if (t.next[voice] != kNoVoice) {
+    t.previous[t.next[voice]] = t.previous[voice];
+  } else {
+    t.tail[list] = t.previous[voice];
   }
 }
 
 /* static */
 uint8_t VoiceAllocator::NoteOn(uint8_t note) {
-  if (size_ == 0) {
-    return 0xff;
+  Tables& t = tables();
+  if (t.size == 0) {
+    return kNoVoice;
   }
   
-  uint8_t voice = 0xff;
   // First, check if there is a voice currently playing this note. In this case
   // This voice will be responsible for retriggering this note.
   // Hint: if you're more into string instruments than keyboard instruments,
   // you can safely comment those lines.
-  for (uint8_t i = 0; i < size_; ++i) {
-    if (pool_[i].note == note) {
-      voice = i;
-      break;
-    }
-  }
+  uint8_t voice = t.note_voice[U7(note)];
   
-  // Then, try to find the least recently touched, currently inactive voice.
-  if (voice == 0xff) {
-    for (uint8_t i = 0; i < kMaxPolyphony; ++i) {
-      if (lru_[i] < size_ && !pool_[lru_[i]].active) {
-        voice = lru_[i];
-      }
+  if (voice == kNoVoice) {
+    // Then, try to find the least recently touched, currently inactive voice.
+    voice = t.tail[RELEASED_VOICES];
+    // If all voices are active, use the least recently played note.
+    if (voice == kNoVoice) {
+      voice = t.tail[ACTIVE_VOICES];
     }
-  }
-  // If all voices are active, use the least recently played note.
-  if (voice == 0xff) {
-    for (uint8_t i = 0; i < kMaxPolyphony; ++i) {
-      if (lru_[i] < size_) {
-        voice = lru_[i];
-      }
+    if (t.note_voice[U7(t.note[voice])] == voice) {
+      t.note_voice[U7(t.note[voice])] = kNoVoice;
     }
+    t.note[voice] = note;
+    t.note_voice[U7(note)] = voice;
   }
-  pool_[voice].note = note;
-  pool_[voice].active = 1;
-  Touch(voice);
+  Unlink(voice);
+  set_active(voice, true);
+  Link(voice, true);
   return voice;
 }
 
 /* static */
 uint8_t VoiceAllocator::NoteOff(uint8_t note) {
-  uint8_t voice = 0xff;
-  for (uint8_t i = 0; i < size_; ++i) {
-    if (pool_[i].note == note) {
-      voice = i;
-    }
-  }
-  if (voice != 0xff) {
-    pool_[voice].active = 0;
-    Touch(voice);
+  Tables& t = tables();
+  uint8_t voice = t.note_voice[U7(note)];
+  if (voice != kNoVoice) {
+    Unlink(voice);
+    set_active(voice, false);
+    Link(voice, true);
   }
   return voice;
 }
 
-/* static */
-void VoiceAllocator::Touch(uint8_t voice) {
-  int8_t source = kMaxPolyphony - 1;
-  int8_t destination = kMaxPolyphony - 1;
-  while (source >= 0) {
-    if (lru_[source] != voice) {
-      lru_[destination--] = lru_[source];
-    }
-    --source;
-  }
-  lru_[0] = voice;
-}
-
 /* extern */
 VoiceAllocator voice_allocator;
 
@@ -16,43 +16,80 @@
 // -----------------------------------------------------------------------------
 //
 // Polyphonic voice allocator.
+//
+// The voices in use are split in two lists, one for the active voices and one
+// for the released ones, each sorted from the most recently touched to the
+// least recently touched voice. A table gives the voice last assigned to each
+// note, so that allocating, releasing or stealing a voice does not require
+// scanning the pool.
 
 #ifndef MIDIPAL_VOICE_ALLOCATOR_H_
 #define MIDIPAL_VOICE_ALLOCATOR_H_
 
 #include "avrlib/base.h"
 
+#include "midipal/notes.h"
+
 static const uint8_t kMaxPolyphony = 20;
 
 namespace midipal {
 
-struct VoiceEntry {
-  uint8_t note;
-  uint8_t active;
-};
+static const uint8_t kNoVoice = 0xff;
+// Note of the voices which have never been used.
+static const uint8_t kNoNote = 0xff;
+
+// In the app arena, past the note map, which the dispatcher uses too.
+static const uint16_t kVoiceAllocatorArenaOffset = kNoteMapArenaEnd;
 
 class VoiceAllocator {
  public: 
   VoiceAllocator() { }
-  static void Init() { size_ = 0; Clear(); }
+  static void Init() { tables().size = 0; Clear(); }
   static void set_size(uint8_t size) {
-    size_ = size;
+    if (size != tables().size) {
+      Resize(size);
+    }
   }
   static uint8_t NoteOn(uint8_t note);
   static uint8_t NoteOff(uint8_t note);
 
+  struct Tables {
+    uint8_t note[kMaxPolyphony];
+    uint8_t active[(kMaxPolyphony + 7) / 8];
+    // Intrusive doubly linked lists of the voices below size.
+    uint8_t previous[kMaxPolyphony];
+    uint8_t next[kMaxPolyphony];
+    uint8_t head[2];  // Most recently touched.
+    uint8_t tail[2];  // Least recently touched.
+    uint8_t note_voice[128];
+    uint8_t size;
+  };
+
  private:
+  enum VoiceList {
+    RELEASED_VOICES,
+    ACTIVE_VOICES
+  };
+
   static void Clear();
-  static void Touch(uint8_t voice);
-   
-  static VoiceEntry pool_[kMaxPolyphony];
-  // Holds the indices of the voices sorted by most recent usage.
-  static uint8_t lru_[kMaxPolyphony];
-  static uint8_t size_;
+  static void Resize(uint8_t size);
+  static bool active(uint8_t voice) {
+    return tables().active[voice >> 3] & (1 << (voice & 7));
+  }
+  static void set_active(uint8_t voice, bool active);
+  static void Link(uint8_t voice, bool at_head);
+  static void Unlink(uint8_t voice);
+
+  static Tables& tables() {
+    return ArenaObject<Tables, kVoiceAllocatorArenaOffset>::get();
+  }
 
   DISALLOW_COPY_AND_ASSIGN(VoiceAllocator);
 };
 
+static const uint16_t kVoiceAllocatorArenaEnd =
+    kVoiceAllocatorArenaOffset + sizeof(VoiceAllocator::Tables);
+
 extern VoiceAllocator voice_allocator;
 
 }  // namespace midipal